@@ -32,6 +32,8 @@ Define_Module(CoCCUDPTransport);
 #define COCC_STREAM_START_EVT_MSG_KIND 9812
 #define COCC_STREAM_STOP_EVT_MSG_KIND 9813
 #define COCC_COMMIT_EVT_MSG_KIND 9814
+#define COCC_TIMER_QUEUE_MSG_KIND 9815
+#define COCC_RATE_LIMIT_EVT_MSG_KIND 9816
 #define COCC_EMPTY_PUSH_MSG_KIND 9821
 
 #define COCC_STREAM_START_INTERVALS 3
@@ -46,14 +48,16 @@ CoCCUDPTransport::CoCCUDPTransport() {
 }
 
 CoCCUDPTransport::~CoCCUDPTransport() {
-    for (auto handle : connectionVect) {
+    for (auto handle : connectionTable) {
         delete handle;
     }
 
-    // no need to delete listenSocket, since it is also stored in connectionVect
+    // no need to delete listenSocket, since it is also stored in connectionTable
 
-    connectionMap.clear();
-    connectionVect.clear();
+    connectionTable.clear();
+    socketTimers.clear();
+
+    cancelAndDelete(timerQueueEvent);
 }
 
 CoCCUDPTransport::SocketHandle_t::~SocketHandle_t() {
@@ -69,6 +73,14 @@ CoCCUDPTransport::SocketHandle_t::~SocketHandle_t() {
     if (targetCommitEvent && !targetCommitEvent->isScheduled()) {
         delete targetCommitEvent;
     }
+    if (rateLimitEvent && !rateLimitEvent->isScheduled()) {
+        delete rateLimitEvent;
+    }
+
+    for (auto &queued : rateLimitQueue) {
+        delete queued.pkt;
+        delete queued.networkOptions;
+    }
 }
 
 void CoCCUDPTransport::initialize() {
@@ -125,10 +137,24 @@ void CoCCUDPTransport::initialize() {
     lowerLayerOverhead = par("lowerLayerOverhead").intValue();
     metadataOverhead = par("metadataOverhead").intValue();
     permittedBurstSize = par("permittedBurstSize").intValue();
+    replaceQueuedControlSequences = par("replaceQueuedControlSequences").boolValue();
+
+    const long queueLength = par("rateLimitQueueLength").intValue();
+
+    if (queueLength < 0) {
+        error("rate limit queue length violates constraint 0 <= %ld", queueLength);
+    }
+    rateLimitQueueLength = queueLength;
 
     coexistenceMode = static_cast<CoexistenceMode>(par("coexistenceMode").intValue());
     qmDesired = par("qmDesired").doubleValue();
 
+    multiplexSocketTimers = par("multiplexSocketTimers").boolValue();
+
+    if (multiplexSocketTimers) {
+        timerQueueEvent = new cMessage("CoCC socket timer queue event", COCC_TIMER_QUEUE_MSG_KIND);
+    }
+
     if (coexistenceMode < CM_DISABLED || coexistenceMode > CM_TOTAL_SUBMISSION) {
         error("unknown/unsupported coexistenceMode %d", coexistenceMode);
     }
@@ -201,26 +227,35 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
     } else if (msg->arrivedOn(upIn->getId())) {
         cObject * const ctrlInfo = msg->getControlInfo();
 
-        if (dynamic_cast<TransportConnectReq *>(ctrlInfo)) {
-            TransportConnectReq * const req = dynamic_cast<TransportConnectReq *>(ctrlInfo);
+        switch (getTransportCtrlKind(ctrlInfo)) {
+        case TRANSPORT_CTRL_CONNECT_REQ: {
+            ASSERT(dynamic_cast<TransportConnectReq *>(ctrlInfo));
+
+            TransportConnectReq * const req = static_cast<TransportConnectReq *>(ctrlInfo);
 
             ASSERT(req);
 
             processConnectRequest(req);
 
             delete msg;
-        } else if (dynamic_cast<TransportListenReq *>(ctrlInfo)) {
-            const uint16_t listenPort = dynamic_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
+
+            break;
+        }
+        case TRANSPORT_CTRL_LISTEN_REQ: {
+            ASSERT(dynamic_cast<TransportListenReq *>(ctrlInfo));
+
+            const uint16_t listenPort = static_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
 
             delete msg;
 
             processListenRequest(listenPort);
-        } else if (dynamic_cast<TransportSetTranslator *>(ctrlInfo)) {
-            TransportSetTranslator * const req = dynamic_cast<TransportSetTranslator *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportSetTranslator control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_SET_TRANSLATOR: {
+            ASSERT(dynamic_cast<TransportSetTranslator *>(ctrlInfo));
+
+            TransportSetTranslator * const req = static_cast<TransportSetTranslator *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -231,12 +266,13 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportStreamStartInfo *>(ctrlInfo)) {
-            TransportStreamStartInfo * const req = dynamic_cast<TransportStreamStartInfo *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportStreamStartInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_STREAM_START: {
+            ASSERT(dynamic_cast<TransportStreamStartInfo *>(ctrlInfo));
+
+            TransportStreamStartInfo * const req = static_cast<TransportStreamStartInfo *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -247,12 +283,13 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportStreamStopInfo *>(ctrlInfo)) {
-            TransportStreamStopInfo * const req = dynamic_cast<TransportStreamStopInfo *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportStreamStopInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_STREAM_STOP: {
+            ASSERT(dynamic_cast<TransportStreamStopInfo *>(ctrlInfo));
+
+            TransportStreamStopInfo * const req = static_cast<TransportStreamStopInfo *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -263,15 +300,17 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportDataInfo *>(ctrlInfo)) {
-            TransportDataInfo * const req = dynamic_cast<TransportDataInfo *>(msg->removeControlInfo());
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportDataInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_DATA: {
+            ASSERT(dynamic_cast<TransportDataInfo *>(ctrlInfo));
+
+            TransportDataInfo * const req = static_cast<TransportDataInfo *>(msg->removeControlInfo());
+
             ASSERT(dynamic_cast<RawPacket *>(msg));
 
-            RawPacket * const pkt = dynamic_cast<RawPacket *>(msg);
+            RawPacket * const pkt = static_cast<RawPacket *>(msg);
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
             if (handle) {
@@ -282,22 +321,14 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
                         handle->inactivityCounter = 0;
                     }
 
-                    if (handle->role != NCTXCI_CONTROLLER || !enableRateLimiting || coccRateLimitAccept(handle, pkt)) {
-                        inet::UDPSocket::SendOptions opts;
-
-                        opts.networkOptions = req->replaceNetworkOptions();
-
-                        coccReplyToMonitoringRequest(handle, opts.networkOptions); // reply to monitoring request, if pending
-                        coccPushMetadata(handle, opts.networkOptions); // initiate push if not already done in period
-                        coccCoexistenceHandler(handle, opts.networkOptions); // perform traffic differentiation, if enabled
-
-                        handle->socket->sendTo(pkt, handle->remote, handle->port, &opts);
+                    if (handle->role != NCTXCI_CONTROLLER || !enableRateLimiting) {
+                        coccSendData(handle, pkt, req->replaceNetworkOptions());
+                    } else if (rateLimitQueueLength > 0) {
+                        coccRateLimitEnqueue(handle, pkt, req->replaceNetworkOptions());
+                    } else if (coccRateLimitAccept(handle, pkt)) {
+                        coccSendData(handle, pkt, req->replaceNetworkOptions());
                     } else {
-                        emit(s_rateLimitDropSignal, pkt->getByteLength());
-
-                        EV_INFO << "CoCC rate limiter dropping packet of " << pkt->getByteLength() << " bytes" << endl;
-
-                        delete msg;
+                        coccRateLimitDrop(pkt, nullptr);
                     }
                 } else {
                     EV_WARN << "Connection to " << req->getDstAddr() << " is not established yet. Dropping message: " << msg << endl;
@@ -311,7 +342,10 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete req;
-        } else {
+
+            break;
+        }
+        default:
             const char * const name = msg->getName();
 
             delete msg;
@@ -323,16 +357,14 @@ void CoCCUDPTransport::handleMessage(cMessage * const msg) {
 
         switch (msg->getKind()) {
         case COCC_PUSH_TICKER_MSG_KIND:
-            coccHandlePushTicker(msg);
-            break;
         case COCC_STREAM_START_EVT_MSG_KIND:
-            coccHandleStreamStart(msg, simTime());
-            break;
         case COCC_STREAM_STOP_EVT_MSG_KIND:
-            coccHandleStreamStop(msg, simTime());
-            break;
         case COCC_COMMIT_EVT_MSG_KIND:
-            coccHandleCommitTicker(msg);
+        case COCC_RATE_LIMIT_EVT_MSG_KIND:
+            handleSocketTimer(msg);
+            break;
+        case COCC_TIMER_QUEUE_MSG_KIND:
+            handleTimerQueueEvent();
             break;
         case CONNECT_TICKER_KIND:
             handleConnectTimeout(msg);
@@ -384,7 +416,7 @@ void CoCCUDPTransport::handleIncomingHandshake(UDPHandshake * const hs,
         txHandle->socket->sendTo(hs, txHandle->remote, txHandle->port);
     } else {
         // client side part, set port and flag connection as established
-        handle->port = ctrl->getSrcPort();
+        connectionTable.updatePort(handle, ctrl->getSrcPort());
         handle->connected = true;
 
         delete hs;
@@ -745,7 +777,7 @@ void CoCCUDPTransport::coccProcessFeedback(SocketHandle_t * const handle, Transp
     const simtime_t commitTime = (handle->feedback.period + 1 + ackFraction) * collectionInterval;
 
     if (simTime() < commitTime) {
-        scheduleAt(commitTime, handle->targetCommitEvent);
+        scheduleSocketTimer(handle->targetCommitEvent, commitTime);
 
         EV_DEBUG << "commit scheduled for " << commitTime << endl;
     } else {
@@ -766,16 +798,14 @@ void CoCCUDPTransport::coccHandleStreamStart(cMessage * const msg, simtime_t sta
 void CoCCUDPTransport::coccHandleStreamStart(SocketHandle_t * const handle, simtime_t start) {
     if (start > simTime() + COCC_STREAM_START_INTERVALS * collectionInterval) {
         if (handle->streamStartEvent) {
-            if (handle->streamStartEvent->isScheduled()) {
-                cancelEvent(handle->streamStartEvent);
-            }
+            cancelSocketTimer(handle->streamStartEvent);
         } else {
            handle->streamStartEvent = new cMessage("CoCC stream start event", COCC_STREAM_START_EVT_MSG_KIND);
            handle->streamStartEvent->setContextPointer(handle);
         }
 
         // schedule for later start
-        scheduleAt(start - COCC_STREAM_START_INTERVALS * collectionInterval, handle->streamStartEvent);
+        scheduleSocketTimer(handle->streamStartEvent, start - COCC_STREAM_START_INTERVALS * collectionInterval);
     } else {
         // trigger state reset, as if push had ben stopped due to inactivity
         handle->inactivityCounter = COCC_INACTIVITY_STOP;
@@ -803,16 +833,14 @@ void CoCCUDPTransport::coccHandleStreamStop(SocketHandle_t * const handle, simti
 
     if (simTime() < handle->stopTime) {
         if (handle->streamStopEvent) {
-            if (handle->streamStopEvent->isScheduled()) {
-                cancelEvent(handle->streamStopEvent);
-            }
+            cancelSocketTimer(handle->streamStopEvent);
         } else {
            handle->streamStopEvent = new cMessage("CoCC stream stop event", COCC_STREAM_STOP_EVT_MSG_KIND);
            handle->streamStopEvent->setContextPointer(handle);
         }
 
         // schedule for later start
-        scheduleAt(handle->stopTime, handle->streamStopEvent);
+        scheduleSocketTimer(handle->streamStopEvent, handle->stopTime);
     } else {
         EV_DEBUG << "Received stream stop signal, ticker will time out after this period." << endl;
 
@@ -859,7 +887,7 @@ void CoCCUDPTransport::coccSetTranslator(SocketHandle_t * const handle, ICoCCTra
     }
 
     // update expected bit rate for rate limiting
-    handle->expectedBitRate = translator->getRateForQM(translator->getActualQM(), translator->getTargetQM());
+    coccSetExpectedBitRate(handle, translator->getRateForQM(translator->getActualQM(), translator->getTargetQM()));
 
     if (oldPtr != nullptr) {
         oldPtr->setControlObserver(nullptr); // unregister
@@ -907,7 +935,7 @@ bool CoCCUDPTransport::coccReplyToMonitoringRequest(SocketHandle_t * const handl
         SerumSupport::initiateResponse(handle->pendingRequest.get(), hho, DATASET_COCC_RESP);
         handle->pendingRequest.reset();
 
-        cancelEvent(handle->pushTicker);
+        cancelSocketTimer(handle->pushTicker);
 
         emit(s_pushForced, forced);
 
@@ -982,10 +1010,10 @@ void CoCCUDPTransport::coccSchedulePushTicker(SocketHandle_t * const handle) {
     EV_DEBUG << "window: " << pushWindow << " offset: " << pushWindowOffset << " forced push at: " << handle->forcedPushTime << " regular at packet: " << handle->pushWaitCounter << endl;
 
     // reschedule push ticker
-    cancelEvent(handle->pushTicker);
+    cancelSocketTimer(handle->pushTicker);
 
     if (handle->forcedPushTime >= simTime()) {
-        scheduleAt(handle->forcedPushTime, handle->pushTicker);
+        scheduleSocketTimer(handle->pushTicker, handle->forcedPushTime);
 
         if (!driving) {
             emit(s_responseMissed, false);
@@ -1000,7 +1028,7 @@ void CoCCUDPTransport::coccSchedulePushTicker(SocketHandle_t * const handle) {
             // push will arrive before end of period. immediately force a push
             handle->forcedPushTime = simTime();
 
-            scheduleAt(handle->forcedPushTime, handle->pushTicker);
+            scheduleSocketTimer(handle->pushTicker, handle->forcedPushTime);
 
             emit(s_periodMismatch, false);
         } else {
@@ -1225,6 +1253,71 @@ void CoCCUDPTransport::coccCoexistenceHandler(SocketHandle_t * const handle, Net
     }
 }
 
+void CoCCUDPTransport::scheduleSocketTimer(cMessage * const timer, const simtime_t& deadline) {
+    if (!multiplexSocketTimers) {
+        scheduleAt(deadline, timer);
+        return;
+    }
+
+    socketTimers.schedule(timer, deadline);
+
+    // only move the queue event forward, a later first deadline is handled lazily
+    if (!timerQueueEvent->isScheduled() || deadline < timerQueueEvent->getArrivalTime()) {
+        cancelEvent(timerQueueEvent);
+        scheduleAt(deadline, timerQueueEvent);
+    }
+}
+
+void CoCCUDPTransport::cancelSocketTimer(cMessage * const timer) {
+    if (multiplexSocketTimers) {
+        socketTimers.cancel(timer);
+    } else {
+        cancelEvent(timer);
+    }
+}
+
+bool CoCCUDPTransport::isSocketTimerScheduled(const cMessage * const timer) const {
+    return multiplexSocketTimers ? socketTimers.isScheduled(timer) : timer->isScheduled();
+}
+
+void CoCCUDPTransport::handleSocketTimer(cMessage * const timer) {
+    switch (timer->getKind()) {
+    case COCC_PUSH_TICKER_MSG_KIND:
+        coccHandlePushTicker(timer);
+        break;
+    case COCC_STREAM_START_EVT_MSG_KIND:
+        coccHandleStreamStart(timer, simTime());
+        break;
+    case COCC_STREAM_STOP_EVT_MSG_KIND:
+        coccHandleStreamStop(timer, simTime());
+        break;
+    case COCC_COMMIT_EVT_MSG_KIND:
+        coccHandleCommitTicker(timer);
+        break;
+    case COCC_RATE_LIMIT_EVT_MSG_KIND:
+        coccHandleRateLimitTicker(timer);
+        break;
+    default:
+        throw cRuntimeError("Unexpected socket timer: %s", timer->getName());
+    }
+}
+
+void CoCCUDPTransport::handleTimerQueueEvent() {
+    cMessage * timer;
+
+    // timers scheduled for now by one of the handlers are dispatched within the same loop
+    while ((timer = socketTimers.popExpired(simTime())) != nullptr) {
+        handleSocketTimer(timer);
+    }
+
+    // handlers may have moved the queue event, re-arm it for the earliest remaining deadline
+    cancelEvent(timerQueueEvent);
+
+    if (!socketTimers.empty()) {
+        scheduleAt(socketTimers.nextDeadline(), timerQueueEvent);
+    }
+}
+
 void CoCCUDPTransport::coccHandlePushTicker(cMessage * const msg) {
     SocketHandle_t* const handle = (SocketHandle_t*) (msg->getContextPointer());
 
@@ -1256,7 +1349,7 @@ void CoCCUDPTransport::coccHandleDrivingPushTicker(SocketHandle_t * const handle
     }
 
     // reschedule ticker timer one interval into future
-    if (!handle->pushTicker->isScheduled()) {
+    if (!isSocketTimerScheduled(handle->pushTicker)) {
         if (handle->inactivityCounter < COCC_INACTIVITY_STOP) {
             // required if connection is not established yet to continue probing
             coccSchedulePushTicker(handle);
@@ -1271,11 +1364,11 @@ void CoCCUDPTransport::coccHandleDrivingPushTicker(SocketHandle_t * const handle
             EV_DEBUG << "CCoC push ticker disabled due to inactivity" << endl;
 
             handle->translator->setTargetQM(0);
-            handle->expectedBitRate = handle->translator->getRateForQM(handle->translator->getActualQM(), 0);
+            coccSetExpectedBitRate(handle, handle->translator->getRateForQM(handle->translator->getActualQM(), 0));
 
             EV_DEBUG << "Resetting target QM to 0" << endl;
 
-            cancelEvent(handle->targetCommitEvent);
+            cancelSocketTimer(handle->targetCommitEvent);
         }
     }
 }
@@ -1298,7 +1391,7 @@ void CoCCUDPTransport::coccHandleCommitTicker(cMessage * const msg) {
     ASSERT(handle);
 
     if (handle->translator && handle->feedback.valid) { // translator might be gone, this check is not for controller vs. non-controller
-        handle->expectedBitRate = handle->feedback.targetBitRate;
+        coccSetExpectedBitRate(handle, handle->feedback.targetBitRate);
 
         const double targetQM = handle->translator->getQMForRate(handle->translator->getActualQM(), handle->expectedBitRate);
 
@@ -1313,15 +1406,49 @@ void CoCCUDPTransport::coccHandleCommitTicker(cMessage * const msg) {
     // commit ticker is rescheduled when push response is received
 }
 
-bool CoCCUDPTransport::coccRateLimitAccept(SocketHandle_t * const handle, cPacket * const pkt) {
-    ASSERT(handle);
-    ASSERT(pkt);
+void CoCCUDPTransport::coccSetExpectedBitRate(SocketHandle_t * const handle, const double expectedBitRate) {
+    if (handle->rateLimitQueue.empty()) {
+        handle->expectedBitRate = expectedBitRate;
+        return;
+    }
+
+    // credit accrued so far is settled at the old rate, the release timer is re-armed for the new one
+    coccRateLimitRefill(handle);
 
+    handle->expectedBitRate = expectedBitRate;
+
+    coccRateLimitArm(handle);
+}
+
+void CoCCUDPTransport::coccRateLimitRefill(SocketHandle_t * const handle) {
     const simtime_t now = simTime();
 
-    handle->burstCredit += (now - handle->lastCreditUpdate).dbl() * handle->expectedBitRate;
-    handle->burstCredit = std::min(handle->burstCredit, permittedBurstSize * 8L);
+    const double refill = (now - handle->lastCreditUpdate).dbl() * handle->expectedBitRate;
+
+    if (rateLimitQueueLength > 0) {
+        // shaping releases packets as soon as the credit suffices, thus the
+        // fractional bits of the refill are carried over instead of being truncated
+        const double credit = handle->burstCredit + handle->burstCreditFraction + refill;
+
+        handle->burstCredit = static_cast<long>(credit);
+        handle->burstCreditFraction = credit - handle->burstCredit;
+    } else {
+        handle->burstCredit += refill;
+    }
+
+    if (handle->burstCredit >= permittedBurstSize * 8L) {
+        handle->burstCredit = permittedBurstSize * 8L;
+        handle->burstCreditFraction = 0;
+    }
+
     handle->lastCreditUpdate = now;
+}
+
+bool CoCCUDPTransport::coccRateLimitAccept(SocketHandle_t * const handle, cPacket * const pkt) {
+    ASSERT(handle);
+    ASSERT(pkt);
+
+    coccRateLimitRefill(handle);
 
     long expectedPktLength = pkt->getBitLength() + lowerLayerOverhead * 8;
 
@@ -1334,6 +1461,101 @@ bool CoCCUDPTransport::coccRateLimitAccept(SocketHandle_t * const handle, cPacke
     }
 }
 
+void CoCCUDPTransport::coccRateLimitEnqueue(SocketHandle_t * const handle, cPacket * const pkt, NetworkOptions * const networkOptions) {
+    if (pkt->getBitLength() + lowerLayerOverhead * 8 >= permittedBurstSize * 8L) {
+        // would never conform, the burst credit is capped below the packet size
+        coccRateLimitDrop(pkt, networkOptions);
+        return;
+    }
+
+    if (replaceQueuedControlSequences) {
+        // the controller transmits control sequences only, the new one supersedes all queued ones
+        while (!handle->rateLimitQueue.empty()) {
+            const QueuedPacket stale = handle->rateLimitQueue.front();
+
+            handle->rateLimitQueue.pop_front();
+
+            EV_DEBUG << "CoCC rate limiter replacing queued control sequence" << endl;
+
+            coccRateLimitDrop(stale.pkt, stale.networkOptions);
+        }
+    } else if (handle->rateLimitQueue.size() >= rateLimitQueueLength) {
+        coccRateLimitDrop(pkt, networkOptions);
+        return;
+    }
+
+    if (!handle->rateLimitEvent) {
+        handle->rateLimitEvent = new cMessage("CoCC rate limit release event", COCC_RATE_LIMIT_EVT_MSG_KIND);
+        handle->rateLimitEvent->setContextPointer(handle);
+    }
+
+    handle->rateLimitQueue.push_back({pkt, networkOptions});
+
+    coccRateLimitRelease(handle);
+}
+
+void CoCCUDPTransport::coccRateLimitRelease(SocketHandle_t * const handle) {
+    while (!handle->rateLimitQueue.empty() && coccRateLimitAccept(handle, handle->rateLimitQueue.front().pkt)) {
+        const QueuedPacket released = handle->rateLimitQueue.front();
+
+        handle->rateLimitQueue.pop_front();
+
+        coccSendData(handle, released.pkt, released.networkOptions);
+    }
+
+    coccRateLimitArm(handle);
+}
+
+void CoCCUDPTransport::coccRateLimitArm(SocketHandle_t * const handle) {
+    cancelSocketTimer(handle->rateLimitEvent);
+
+    if (!handle->rateLimitQueue.empty()) {
+        // credit is up to date, wait until it exceeds the head packet at the expected rate
+        const long pktLength = handle->rateLimitQueue.front().pkt->getBitLength() + lowerLayerOverhead * 8;
+        const double deficit = pktLength + 1 - (handle->burstCredit + handle->burstCreditFraction);
+        simtime_t wait = collectionInterval;
+
+        if (deficit <= 0) {
+            // credit already suffices, e.g. after settling it at a changed rate
+            wait = SIMTIME_ZERO;
+        } else if (handle->expectedBitRate > 0) {
+            // round up to the next tick, plus one tick as margin for the rounding of the refill
+            wait.setRaw(static_cast<int64_t>(std::ceil(deficit / handle->expectedBitRate * SimTime::getScale())) + 1);
+        }
+
+        scheduleSocketTimer(handle->rateLimitEvent, simTime() + wait);
+    }
+}
+
+void CoCCUDPTransport::coccRateLimitDrop(cPacket * const pkt, NetworkOptions * const networkOptions) {
+    emit(s_rateLimitDropSignal, pkt->getByteLength());
+
+    EV_INFO << "CoCC rate limiter dropping packet of " << pkt->getByteLength() << " bytes" << endl;
+
+    delete pkt;
+    delete networkOptions;
+}
+
+void CoCCUDPTransport::coccHandleRateLimitTicker(cMessage * const msg) {
+    SocketHandle_t* const handle = (SocketHandle_t*) (msg->getContextPointer());
+
+    ASSERT(handle);
+
+    coccRateLimitRelease(handle);
+}
+
+void CoCCUDPTransport::coccSendData(SocketHandle_t * const handle, cPacket * const pkt, NetworkOptions * const networkOptions) {
+    inet::UDPSocket::SendOptions opts;
+
+    opts.networkOptions = networkOptions;
+
+    coccReplyToMonitoringRequest(handle, opts.networkOptions); // reply to monitoring request, if pending
+    coccPushMetadata(handle, opts.networkOptions); // initiate push if not already done in period
+    coccCoexistenceHandler(handle, opts.networkOptions); // perform traffic differentiation, if enabled
+
+    handle->socket->sendTo(pkt, handle->remote, handle->port, &opts);
+}
+
 void CoCCUDPTransport::postControlStep(void * const context) {
     SocketHandle_t * const handle = (SocketHandle_t *)context;
 
@@ -1390,12 +1612,10 @@ void CoCCUDPTransport::connectSocket(SocketHandle_t * const handle, const L3Addr
 void CoCCUDPTransport::storeSocket(SocketHandle_t * const handle) {
     ASSERT(handle);
 
-    // may fail for incoming connections tied to the listen socket
-    // thats ok, we use the map in first place to retrieve the listen socket or
-    // to check if a socket context has been established. thus no assert here
-    connectionMap.insert(SocketMap_t::value_type(handle->socket->getSocketId(), handle));
-
-    connectionVect.insert(connectionVect.end(), handle);
+    // the ID of incoming connections tied to the listen socket stays associated
+    // with the listen socket. thats ok, we use the ID in first place to retrieve
+    // the listen socket or to check if a socket context has been established
+    connectionTable.insert(handle->socket->getSocketId(), handle);
 }
 
 void CoCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * const selfMsg) {
@@ -1414,14 +1634,9 @@ void CoCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * c
  * connections, or the socket associated with an outgoing connection.
  */
 CoCCUDPTransport::SocketHandle_t * CoCCUDPTransport::getSocketById(const int id) {
-    const auto it = connectionMap.find(id);
+    SocketHandle_t * const handle = connectionTable.findById(id);
 
-    if (it == connectionMap.end()) {
-        return nullptr;
-    }
-
-    SocketHandle_t * const handle = it->second;
-    ASSERT(it->first == handle->socket->getSocketId());
+    ASSERT(!handle || id == handle->socket->getSocketId());
 
     return handle;
 }
@@ -1435,17 +1650,5 @@ CoCCUDPTransport::SocketHandle_t * CoCCUDPTransport::getSocketById(const int id)
  * requiring the server to know the dst port of the client.
  */
 CoCCUDPTransport::SocketHandle_t * CoCCUDPTransport::getSocketByAddr(const L3Address& addr, const uint16_t port) {
-    SocketHandle_t * handle = nullptr;
-
-    for (auto it = connectionVect.begin(); it != connectionVect.end(); it++) {
-        if ((*it)->remote == addr) {
-            handle = *it; // address match, but a perfect one might be possible
-
-            if (handle->port == port) {
-                break; // perfect match, do not continue
-            }
-        }
-    }
-
-    return handle;
+    return connectionTable.findByAddr(addr, port);
 }
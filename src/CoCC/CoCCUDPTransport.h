@@ -18,6 +18,7 @@
 
 #include <omnetpp.h>
 
+#include <deque>
 #include <memory>
 
 #include <inet/networklayer/serum/SerumSupport.h>
@@ -27,6 +28,8 @@
 #include "CoCCSerumHeader_m.h"
 #include "util/UDPHandshakePkt_m.h"
 #include "util/TransportCtrlMsg.h"
+#include "util/SocketTable.h"
+#include "util/TimerQueue.h"
 #include "MockImpl/util/WindowStats.h"
 
 using namespace omnetpp;
@@ -85,6 +88,10 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
         double targetQM;      // with local adjustments
         double targetBitRate; // bitrate for targetQM
     };
+    struct QueuedPacket {
+        cPacket * pkt;
+        NetworkOptions * networkOptions;
+    };
     struct SocketHandle_t {
         std::shared_ptr<UDPSocket> socket;
 
@@ -100,6 +107,7 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
         cMessage * streamStopEvent = nullptr;
         cMessage * pushTicker = nullptr;
         cMessage * targetCommitEvent = nullptr;
+        cMessage * rateLimitEvent = nullptr;
         simtime_t collectionPeriodStart;
         simtime_t pushStart;
         int pushWaitCounter;
@@ -114,8 +122,10 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
         FeedbackData feedback;
 
         long burstCredit;
+        double burstCreditFraction = 0; // fractional bits of burstCredit, only carried if shaping is enabled
         double expectedBitRate;
         simtime_t lastCreditUpdate;
+        std::deque<QueuedPacket> rateLimitQueue; // packets held back by the rate limiter, if shaping is enabled
 
         double lbeClassAccumulator = 0;
 
@@ -124,8 +134,7 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
 
         ~SocketHandle_t();
     };
-    typedef std::map<int, SocketHandle_t *> SocketMap_t;
-    typedef std::vector<SocketHandle_t *> SocketVector_t;
+    typedef SocketTable<SocketHandle_t> SocketTable_t;
 
     // variables
     cGate *udpIn;
@@ -150,8 +159,7 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
     simsignal_t s_pushForced;
     simsignal_t s_forcedPushCompensation;
 
-    SocketMap_t connectionMap; // ConnId --> SocketHandle_t;
-    SocketVector_t connectionVect;
+    SocketTable_t connectionTable; // ConnId, remote address --> SocketHandle_t
     SocketHandle_t * listenSocket = nullptr;
 
     simtime_t collectionInterval;
@@ -171,10 +179,17 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
     int lowerLayerOverhead;
     int metadataOverhead;
     int permittedBurstSize;
+    unsigned int rateLimitQueueLength;
+    bool replaceQueuedControlSequences;
 
     CoexistenceMode coexistenceMode;
     double qmDesired;
 
+    // per-socket timers, multiplexed onto timerQueueEvent if multiplexSocketTimers is set
+    bool multiplexSocketTimers;
+    TimerQueue socketTimers;
+    cMessage * timerQueueEvent = nullptr;
+
     // inout processing
     TransportDataInfo * createTransportInfo(UDPDataIndication * const ctrl);
     void handleIncomingHandshake(UDPHandshake * const hs, UDPDataIndication * const ctrl,
@@ -183,6 +198,13 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
     void processListenRequest(const uint16_t listenPort);
     void handleConnectTimeout(cMessage* const msg);
 
+    // per-socket timer management
+    void scheduleSocketTimer(cMessage * const timer, const simtime_t& deadline);
+    void cancelSocketTimer(cMessage * const timer);
+    bool isSocketTimerScheduled(const cMessage * const timer) const;
+    void handleSocketTimer(cMessage * const timer);
+    void handleTimerQueueEvent();
+
     // CoCC
     void coccProcessMonitoringRequest(SocketHandle_t * const handle, TransportDataInfo * const info);
     void coccProcessFeedback(SocketHandle_t * const handle, TransportDataInfo * const info);
@@ -200,7 +222,15 @@ class CoCCUDPTransport : public cSimpleModule, public ICoCCTranslator::IControlO
     void coccHandleDrivingPushTicker(SocketHandle_t * const handle);
     void coccHandleRespondingPushTicker(SocketHandle_t * const handle);
     void coccHandleCommitTicker(cMessage * const msg);
+    void coccSetExpectedBitRate(SocketHandle_t * const handle, const double expectedBitRate);
+    void coccRateLimitRefill(SocketHandle_t * const handle);
     bool coccRateLimitAccept(SocketHandle_t * const handle, cPacket * const pkt);
+    void coccRateLimitEnqueue(SocketHandle_t * const handle, cPacket * const pkt, NetworkOptions * const networkOptions);
+    void coccRateLimitRelease(SocketHandle_t * const handle);
+    void coccRateLimitArm(SocketHandle_t * const handle);
+    void coccRateLimitDrop(cPacket * const pkt, NetworkOptions * const networkOptions);
+    void coccHandleRateLimitTicker(cMessage * const msg);
+    void coccSendData(SocketHandle_t * const handle, cPacket * const pkt, NetworkOptions * const networkOptions);
 
   public:
     virtual void postControlStep(void * const context) override;
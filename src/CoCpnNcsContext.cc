@@ -45,6 +45,18 @@ void CoCpnNcsContext::initialize(const int stage) {
         factor = par("factor").doubleValue();
         offset = par("offset").doubleValue();
 
+        tabulateRateFunction = par("tabulateRateFunction").boolValue();
+        rateTableTolerance = par("rateTableTolerance").doubleValue();
+        memoizeRateQueries = par("memoizeRateQueries").boolValue();
+        warmStartQMSolve = par("warmStartQMSolve").boolValue();
+
+        const long tableIntervals = par("rateTableIntervals").intValue();
+
+        if (tabulateRateFunction && tableIntervals < 1) {
+            error("rateTableIntervals violates constraint 1 <= %ld", tableIntervals);
+        }
+        rateTableIntervals = static_cast<unsigned int>(tableIntervals);
+
         if (qocToQM(1.0) < 1.0) {
             EV_WARN << "WARNING: QoC<->QM mapping is configured such that QM=1 can never be achived. factor=" << factor << " offset=" << offset << endl;
         }
@@ -216,12 +228,35 @@ void CoCpnNcsContext::processControlStepResult(const simtime_t& ncsTime, const N
     emit(reportedQoC, actualQoC);
     emit(reportedQM, CLAMP(qocToQM(actualQoC), 0.0, 1.0));
 
+    // the control step changed the state of the implementation
+    invalidateQueryMemo();
+
     // notify the observer about the current step
     if (observer) {
         observer->postControlStep(observerContext);
     }
 }
 
+void CoCpnNcsContext::writeSnapshot(SnapshotWriter& snapshot) {
+    NcsContext::writeSnapshot(snapshot);
+
+    snapshot.section("CoCpnNcsContext");
+
+    snapshot.value("qoc", actualQoC, targetQM);
+    snapshot.value("payloadSize", avgPayloadSize, payloadSizeSamples, lastPayloadSize);
+}
+
+void CoCpnNcsContext::readSnapshot(SnapshotReader& snapshot) {
+    NcsContext::readSnapshot(snapshot);
+
+    snapshot.section("CoCpnNcsContext");
+
+    snapshot.value("qoc", actualQoC, targetQM);
+    snapshot.value("payloadSize", avgPayloadSize, payloadSizeSamples, lastPayloadSize);
+
+    invalidateQueryMemo();
+}
+
 AbstractCoCpnNcsImpl* CoCpnNcsContext::ncs() {
     ASSERT(dynamic_cast<AbstractCoCpnNcsImpl*>(NcsContext::ncs));
 
@@ -253,6 +288,8 @@ void CoCpnNcsContext::setTargetQM(const double targetQM) {
     const double targetQoC = qmToQoC(targetQM);
 
     ncs()->setTargetQoC(targetQoC);
+    rateTableValid = false;
+    invalidateQueryMemo();
 
     emit(targetQoCSignal, targetQoC);
     emit(targetQMSignal, this->targetQM);
@@ -282,6 +319,7 @@ long CoCpnNcsContext::getPerPacketOverhead() {
 
 void CoCpnNcsContext::setPerPacketOverhead(const long packetOverhead) {
     this->perPacketOverhead = packetOverhead;
+    invalidateQueryMemo();
 }
 
 long CoCpnNcsContext::getNetworkOverhead() {
@@ -290,6 +328,7 @@ long CoCpnNcsContext::getNetworkOverhead() {
 
 void CoCpnNcsContext::setNetworkOverhead(const long networkOverhead) {
     this->networkOverhead = networkOverhead;
+    invalidateQueryMemo();
 }
 
 double CoCpnNcsContext::getMaxRate() {
@@ -300,35 +339,90 @@ double CoCpnNcsContext::getMaxRate() {
 ICoCCTranslator::CoCCLinearization CoCpnNcsContext::getLinearizationForRate(const double actualQM, const double targetQM) {
     ICoCCTranslator::CoCCLinearization result;
 
-    RateAdjustment function(this);
+    const bool memo = useQueryMemo();
+
+    if (memo && linearizationMemo.find(actualQM, targetQM, result.m, result.b)) {
+        return result;
+    }
+
+    if (tabulateRateFunction) {
+        const FunctionTools::TabulatedFunction& table = getRateTable();
+
+        result.m = table.derivative(targetQM);
+        result.b = table(targetQM) - result.m * targetQM;
+    } else {
+        RateAdjustment function(this);
 
-    FunctionTools::Derivative derive(function, DIFF_H);
+        FunctionTools::Derivative derive(function, DIFF_H);
 
-    result.m = derive(targetQM);
-    result.b = function(targetQM) - result.m * targetQM;
+        result.m = derive(targetQM);
+        result.b = function(targetQM) - result.m * targetQM;
+    }
 
     ASSERT(result.m >= 0 - COCC_EPSILON); // negative slopes are not reasonable, catch them
 
     //EV_TRACE << "linearization for QM: " << result.m << " * QM + " << result.b << endl;
     //EV_TRACE << "rate according to linearization at target QM (" << targetQM << "): " << result.m * targetQM + result.b << endl;
 
+    if (memo) {
+        linearizationMemo.store(actualQM, targetQM, result.m, result.b);
+    }
+
     return result;
 }
 
 double CoCpnNcsContext::getRateForQM(const double actualQM, const double targetQM) {
-    RateAdjustment function(this);
+    const bool memo = useQueryMemo();
+    double result, unused;
+
+    if (memo && rateMemo.find(actualQM, targetQM, result, unused)) {
+        return result;
+    }
 
-    return function(targetQM);
+    if (tabulateRateFunction) {
+        result = getRateTable()(targetQM);
+    } else {
+        RateAdjustment function(this);
+
+        result = function(targetQM);
+    }
+
+    if (memo) {
+        rateMemo.store(actualQM, targetQM, result);
+    }
+
+    return result;
 }
 
 double CoCpnNcsContext::getQMForRate(const double actualQM, const double rate) {
-    RateAdjustment function(this);
+    const bool memo = useQueryMemo();
+    double result, unused;
+
+    if (memo && qmMemo.find(actualQM, rate, result, unused)) {
+        return result;
+    }
+
+    if (tabulateRateFunction) {
+        result = getRateTable().inverse(rate);
+    } else {
+        RateAdjustment function(this);
+
+        FunctionTools::Derivative derive(function, DIFF_H);
+        FunctionTools::BisectSolve bisect(function, function.limit, BISECT_ITER_LIMIT, NEWTON_EPSILON);
+        FunctionTools::NewtonSolve newton(derive, bisect, NEWTON_ITER_LIMIT, NEWTON_EPSILON);
+
+        // consecutive solves usually ask for nearby QM values, optionally start at the previous solution
+        const double start = warmStartQMSolve && lastSolvedQM >= 0 ? lastSolvedQM : actualQM;
+
+        result = newton.solve(rate, start);
+        lastSolvedQM = result;
+    }
 
-    FunctionTools::Derivative derive(function, DIFF_H);
-    FunctionTools::BisectSolve bisect(function, function.limit, BISECT_ITER_LIMIT, NEWTON_EPSILON);
-    FunctionTools::NewtonSolve newton(derive, bisect, NEWTON_ITER_LIMIT, NEWTON_EPSILON);
+    if (memo) {
+        qmMemo.store(actualQM, rate, result);
+    }
 
-    return newton.solve(rate, actualQM);
+    return result;
 }
 
 double CoCpnNcsContext::getAvgFrequencyForQM(const double actualQM, const double targetQM) {
@@ -362,6 +456,72 @@ double CoCpnNcsContext::qmToQoC(const double qm) {
     return result;
 }
 
+const FunctionTools::TabulatedFunction& CoCpnNcsContext::getRateTable() {
+    // RateAdjustment depends on the state of the implementation (actual QoC,
+    // model parameters) and the packet size, not on the actualQM argument
+    const double actualQM = getActualQM();
+    const long packetSize = getPayloadSize() + perPacketOverhead;
+    const unsigned long version = ncs()->getRateFunctionVersion();
+
+    if (!rateTableValid || std::abs(actualQM - rateTableQM) > rateTableTolerance
+            || packetSize != rateTablePacketSize || networkOverhead != rateTableNetworkOverhead
+            || version != rateTableVersion) {
+        rateTable.build(RateAdjustment(this), rateTableIntervals);
+
+        rateTableValid = true;
+        rateTableQM = actualQM;
+        rateTablePacketSize = packetSize;
+        rateTableNetworkOverhead = networkOverhead;
+        rateTableVersion = version;
+    }
+
+    return rateTable;
+}
+
+void CoCpnNcsContext::invalidateQueryMemo() {
+    rateMemo.clear();
+    linearizationMemo.clear();
+    qmMemo.clear();
+
+    lastSolvedQM = -1;
+}
+
+bool CoCpnNcsContext::useQueryMemo() {
+    if (!memoizeRateQueries && !warmStartQMSolve) {
+        return false;
+    }
+
+    // the implementation might change its rate function between control steps
+    const unsigned long version = ncs()->getRateFunctionVersion();
+
+    if (version != memoVersion) {
+        invalidateQueryMemo();
+        memoVersion = version;
+    }
+
+    return memoizeRateQueries;
+}
+
+bool CoCpnNcsContext::QueryMemo::find(const double actualQM, const double arg, double &v1, double &v2) const {
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].actualQM == actualQM && entries[i].arg == arg) {
+            v1 = entries[i].v1;
+            v2 = entries[i].v2;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CoCpnNcsContext::QueryMemo::store(const double actualQM, const double arg, const double v1, const double v2) {
+    entries[next] = { actualQM, arg, v1, v2 };
+
+    next = (next + 1) % SIZE;
+    count = std::max(count, next == 0 ? SIZE : next);
+}
+
 CoCpnNcsContext::RateAdjustment::RateAdjustment(CoCpnNcsContext * const parent)
         : parent(parent) {
     ASSERT(parent);
@@ -377,3 +537,27 @@ double CoCpnNcsContext::RateAdjustment::eval(const double targetQM) const {
 
     return result;
 }
+
+bool CoCpnNcsContext::RateAdjustment::evalWithDerivativeImpl(const double targetQM, double &rate, double &slope) const {
+    const double targetQoC = parent->qmToQoC(targetQM);
+
+    if (!parent->ncs()->getRateFunction().evalWithDerivative(targetQoC, rate, slope)) {
+        return false;
+    }
+
+    // chain rule, qmToQoC is linear with slope 1/factor unless clamped
+    const double unclampedQoC = targetQM / parent->factor + parent->offset;
+
+    if (unclampedQoC < 0.0 || unclampedQoC > 1.0) {
+        slope = 0;
+    } else {
+        slope /= parent->factor;
+    }
+
+    const double bitsPerPacket = (parent->getPayloadSize() + parent->perPacketOverhead) * 8;
+
+    rate = rate * bitsPerPacket + parent->networkOverhead * 8;
+    slope *= bitsPerPacket;
+
+    return true;
+}
@@ -20,6 +20,7 @@
 
 #include "NcsContext.h"
 #include "CoCC/CoCCTranslator.h"
+#include "util/FunctionTools.h"
 
 using namespace omnetpp;
 using namespace inet;
@@ -72,6 +73,9 @@ class CoCpnNcsContext : public NcsContext, public ICoCCTranslator {
     virtual AbstractNcsImpl* createNcsImpl(const std::string name) override;
     virtual void processControlStepResult(const simtime_t& ncsTime, const NcsControlStepResult * const result) override;
 
+    virtual void writeSnapshot(SnapshotWriter& snapshot) override;
+    virtual void readSnapshot(SnapshotReader& snapshot) override;
+
   private:
     AbstractCoCpnNcsImpl* ncs();
 
@@ -100,6 +104,9 @@ class CoCpnNcsContext : public NcsContext, public ICoCCTranslator {
   protected:
     double qocToQM(const double qoc);
     double qmToQoC(const double qm);
+    const FunctionTools::TabulatedFunction& getRateTable();
+    void invalidateQueryMemo();
+    bool useQueryMemo();
 
     friend class RateAdjustment;
     class RateAdjustment : public ICoCCTranslator::RateFunction {
@@ -109,10 +116,35 @@ class CoCpnNcsContext : public NcsContext, public ICoCCTranslator {
 
     protected:
         virtual double eval(const double targetQM) const;
+        virtual bool evalWithDerivativeImpl(const double targetQM, double &rate, double &slope) const;
 
         CoCpnNcsContext * const parent;
     };
 
+    /**
+     * Small cache of (actualQM, argument) -> result pairs, replaced round robin.
+     */
+    class QueryMemo {
+    public:
+        bool find(const double actualQM, const double arg, double &v1, double &v2) const;
+        void store(const double actualQM, const double arg, const double v1, const double v2 = 0);
+        void clear() { count = 0; next = 0; };
+
+    protected:
+        struct Entry {
+            double actualQM;
+            double arg;
+            double v1;
+            double v2;
+        };
+
+        static const size_t SIZE = 8;
+
+        Entry entries[SIZE];
+        size_t count = 0;
+        size_t next = 0;
+    };
+
   protected:
 
     //
@@ -130,6 +162,28 @@ class CoCpnNcsContext : public NcsContext, public ICoCCTranslator {
     long payloadSizeSamples = 0;
     long lastPayloadSize = 0;
 
+    /**
+     * Tabulated RateAdjustment and the state it was built for, only used if
+     * tabulateRateFunction is set.
+     */
+    FunctionTools::TabulatedFunction rateTable = FunctionTools::TabulatedFunction(FunctionTools::Clamp(0.0, 1.0));
+    bool rateTableValid = false;
+    double rateTableQM = 0;
+    long rateTablePacketSize = 0;
+    long rateTableNetworkOverhead = 0;
+    unsigned long rateTableVersion = 0;
+
+    /**
+     * Translator query results since the last control step, only used if
+     * memoizeRateQueries is set.
+     */
+    QueryMemo rateMemo;
+    QueryMemo linearizationMemo;
+    QueryMemo qmMemo;
+    unsigned long memoVersion = 0;
+    // start value for the next QM for rate solve if warmStartQMSolve is set, reset along with the memo
+    double lastSolvedQM = -1;
+
     // statistical data
 
     simsignal_t reportedQoC;
@@ -150,6 +204,12 @@ class CoCpnNcsContext : public NcsContext, public ICoCCTranslator {
 
     double factor;
     double offset;
+
+    bool tabulateRateFunction;
+    unsigned int rateTableIntervals;
+    double rateTableTolerance;
+    bool memoizeRateQueries;
+    bool warmStartQMSolve;
 };
 
 class AbstractCoCpnNcsImpl : virtual public AbstractNcsImpl {
@@ -158,6 +218,15 @@ class AbstractCoCpnNcsImpl : virtual public AbstractNcsImpl {
 
     virtual void setTargetQoC(const double qoc) = 0;
     virtual const ICoCCTranslator::RateFunction& getRateFunction() = 0;
+
+    // changes whenever the rate function changed for reasons other than the
+    // actual QoC, e.g. updated model parameters, invalidates tabulated rates
+    unsigned long getRateFunctionVersion() const { return rateFunctionVersion; };
+
+  protected:
+    void rateFunctionChanged() { rateFunctionVersion++; };
+
+    unsigned long rateFunctionVersion = 0;
 };
 
 #endif
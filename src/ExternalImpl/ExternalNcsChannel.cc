@@ -0,0 +1,258 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ExternalNcsChannel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::string errnoMessage(const std::string& what, const std::string& name) {
+    return what + " " + name + " failed: " + std::strerror(errno);
+}
+
+
+ExternalNcsChannel* ExternalNcsChannel::create(const std::string& name, const uint64_t ringSize) {
+    if (ringSize < 64) {
+        throw std::invalid_argument("ring size of external NCS channel is too small");
+    }
+
+    const size_t mappingSize = getHeaderSize() + 2 * ringSize;
+
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+
+    if (fd < 0) {
+        throw std::runtime_error(errnoMessage("creating shared memory segment", name));
+    }
+
+    if (ftruncate(fd, mappingSize) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+
+        throw std::runtime_error(errnoMessage("resizing shared memory segment", name));
+    }
+
+    void * const mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name.c_str());
+
+        throw std::runtime_error(errnoMessage("mapping shared memory segment", name));
+    }
+
+    Segment * const segment = static_cast<Segment *>(mapping);
+
+    segment->ringSize = ringSize;
+
+    for (Ring &ring : segment->rings) {
+        new (&ring.writePos) std::atomic<uint64_t>(0);
+        new (&ring.readPos) std::atomic<uint64_t>(0);
+
+        sem_init(&ring.available, 1, 0);
+        sem_init(&ring.freed, 1, 0);
+    }
+
+    segment->version = VERSION;
+    // publish the initialized segment last, attaching processes check the magic
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = MAGIC;
+
+    return new ExternalNcsChannel(name, mapping, mappingSize, true);
+}
+
+ExternalNcsChannel* ExternalNcsChannel::open(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+    if (fd < 0) {
+        throw std::runtime_error(errnoMessage("opening shared memory segment", name));
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Segment)) {
+        close(fd);
+
+        throw std::runtime_error("invalid shared memory segment " + name);
+    }
+
+    void * const mapping = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(errnoMessage("mapping shared memory segment", name));
+    }
+
+    const Segment * const segment = static_cast<const Segment *>(mapping);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (segment->magic != MAGIC || segment->version != VERSION
+            || static_cast<size_t>(st.st_size) < getHeaderSize() + 2 * segment->ringSize) {
+        munmap(mapping, st.st_size);
+
+        throw std::runtime_error("incompatible shared memory segment " + name);
+    }
+
+    return new ExternalNcsChannel(name, mapping, st.st_size, false);
+}
+
+ExternalNcsChannel::ExternalNcsChannel(const std::string& name, void * const mapping, const size_t mappingSize, const bool owner)
+        : name(name), mapping(mapping), mappingSize(mappingSize), segment(static_cast<Segment *>(mapping)), owner(owner) {
+}
+
+ExternalNcsChannel::~ExternalNcsChannel() {
+    if (owner) {
+        for (Ring &ring : segment->rings) {
+            sem_destroy(&ring.available);
+            sem_destroy(&ring.freed);
+        }
+    }
+
+    munmap(mapping, mappingSize);
+
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+}
+
+bool ExternalNcsChannel::send(const ExternalNcsChannelDirection dir, const ExternalNcsMessage& msg, const long timeoutMs) {
+    Ring &ring = segment->rings[dir];
+    const uint64_t ringSize = segment->ringSize;
+    const uint32_t len = msg.data.size();
+    const uint64_t required = sizeof(len) + len;
+
+    if (required > ringSize) {
+        throw std::length_error("external NCS message exceeds ring size of " + name);
+    }
+
+    const uint64_t writePos = ring.writePos.load(std::memory_order_relaxed);
+
+    // wait until the reader consumed enough messages
+    while (ringSize - (writePos - ring.readPos.load(std::memory_order_acquire)) < required) {
+        if (!wait(&ring.freed, timeoutMs)) {
+            return false;
+        }
+    }
+
+    copyIn(dir, writePos, &len, sizeof(len));
+    copyIn(dir, writePos + sizeof(len), msg.data.data(), len);
+
+    ring.writePos.store(writePos + required, std::memory_order_release);
+
+    sem_post(&ring.available);
+
+    return true;
+}
+
+bool ExternalNcsChannel::receive(const ExternalNcsChannelDirection dir, ExternalNcsMessage& msg, const long timeoutMs) {
+    Ring &ring = segment->rings[dir];
+
+    if (!wait(&ring.available, timeoutMs)) {
+        return false;
+    }
+
+    const uint64_t readPos = ring.readPos.load(std::memory_order_relaxed);
+    uint32_t len;
+
+    // pairs with the release store of the writer, the message is complete
+    if (ring.writePos.load(std::memory_order_acquire) - readPos < sizeof(len)) {
+        throw std::logic_error("inconsistent ring state of " + name);
+    }
+
+    copyOut(dir, readPos, &len, sizeof(len));
+
+    msg.clear();
+    msg.data.resize(len);
+
+    copyOut(dir, readPos + sizeof(len), msg.data.data(), len);
+
+    ring.readPos.store(readPos + sizeof(len) + len, std::memory_order_release);
+
+    sem_post(&ring.freed);
+
+    return true;
+}
+
+size_t ExternalNcsChannel::getHeaderSize() {
+    // ring data starts at a cache line boundary behind the header
+    return (sizeof(Segment) + 63) / 64 * 64;
+}
+
+uint8_t * ExternalNcsChannel::ringData(const ExternalNcsChannelDirection dir) const {
+    return static_cast<uint8_t *>(mapping) + getHeaderSize() + dir * segment->ringSize;
+}
+
+void ExternalNcsChannel::copyIn(const ExternalNcsChannelDirection dir, uint64_t pos, const void * src, size_t len) {
+    uint8_t * const data = ringData(dir);
+    const uint64_t ringSize = segment->ringSize;
+    const size_t offset = pos % ringSize;
+    const size_t first = std::min<size_t>(len, ringSize - offset);
+
+    std::memcpy(data + offset, src, first);
+    std::memcpy(data, static_cast<const uint8_t *>(src) + first, len - first);
+}
+
+void ExternalNcsChannel::copyOut(const ExternalNcsChannelDirection dir, uint64_t pos, void * dst, size_t len) const {
+    const uint8_t * const data = ringData(dir);
+    const uint64_t ringSize = segment->ringSize;
+    const size_t offset = pos % ringSize;
+    const size_t first = std::min<size_t>(len, ringSize - offset);
+
+    std::memcpy(dst, data + offset, first);
+    std::memcpy(static_cast<uint8_t *>(dst) + first, data, len - first);
+}
+
+bool ExternalNcsChannel::wait(sem_t * const sem, const long timeoutMs) {
+    if (timeoutMs < 0) {
+        while (sem_wait(sem) != 0) {
+            if (errno != EINTR) {
+                throw std::runtime_error(std::string("waiting on external NCS channel failed: ") + std::strerror(errno));
+            }
+        }
+
+        return true;
+    }
+
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (sem_timedwait(sem, &deadline) != 0) {
+        if (errno == ETIMEDOUT) {
+            return false;
+        } else if (errno != EINTR) {
+            throw std::runtime_error(std::string("waiting on external NCS channel failed: ") + std::strerror(errno));
+        }
+    }
+
+    return true;
+}
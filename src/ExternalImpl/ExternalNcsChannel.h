@@ -0,0 +1,179 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef EXTERNALIMPL_EXTERNALNCSCHANNEL_H_
+#define EXTERNALIMPL_EXTERNALNCSCHANNEL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <semaphore.h>
+
+// This file is shared with the external worker processes and must not depend on OMNeT++
+
+/**
+ * Calls of an ExternalNcsImpl which are forwarded to a worker process.
+ * Each request starts with the call, the ncsId and the NCS time (in ps),
+ * each response with a status (0 if successful, otherwise followed by an
+ * error message).
+ */
+enum ExternalNcsCall : uint32_t {
+    ENCC_INITIALIZE = 1,    // maxSimTime, configFile, #entries, (key, value)* -> controlPeriod, plantPeriod
+    ENCC_PLANT_STEPS,       // count -> plantStateAdmissible
+    ENCC_CONTROL_STEP,      // -> controllerStateAdmissible, reportedQoC, controlError, estControlError, stageCosts, pkts
+    ENCC_HANDLE_PACKET,     // src, dst, payload -> pktId, isAck, pkts
+    ENCC_FINALIZE,          // -> totalControlCosts, #scalars, (name, value)*
+    ENCC_SHUTDOWN           // terminates the worker process, no response
+};
+
+/**
+ * Direction of a ring within an ExternalNcsChannel
+ */
+enum ExternalNcsChannelDirection {
+    ENCD_REQUEST = 0,   // simulation -> worker
+    ENCD_RESPONSE = 1   // worker -> simulation
+};
+
+/**
+ * Serialization buffer for requests and responses. Values are stored in host
+ * byte order, as both ends always run on the same machine.
+ */
+class ExternalNcsMessage {
+
+public:
+    void clear() { data.clear(); readPos = 0; };
+    size_t size() const { return data.size(); };
+
+    template<typename T> void put(const T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+
+        putBytes(&value, sizeof(T));
+    };
+
+    void putString(const std::string& value) {
+        put<uint32_t>(value.size());
+        putBytes(value.data(), value.size());
+    };
+
+    void putBytes(const void * const buf, const size_t len) {
+        const uint8_t * const bytes = static_cast<const uint8_t *>(buf);
+
+        data.insert(data.end(), bytes, bytes + len);
+    };
+
+    template<typename T> T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+
+        T result;
+
+        std::memcpy(&result, getBytes(sizeof(T)), sizeof(T));
+
+        return result;
+    };
+
+    std::string getString() {
+        const uint32_t len = get<uint32_t>();
+        const uint8_t * const bytes = getBytes(len);
+
+        return std::string(reinterpret_cast<const char *>(bytes), len);
+    };
+
+    const uint8_t * getBytes(const size_t len) {
+        if (len > data.size() - readPos) {
+            throw std::runtime_error("truncated external NCS message");
+        }
+
+        const uint8_t * const result = data.data() + readPos;
+
+        readPos += len;
+
+        return result;
+    };
+
+protected:
+    friend class ExternalNcsChannel;
+
+    std::vector<uint8_t> data;
+    size_t readPos = 0;
+};
+
+/**
+ * Shared memory segment holding two single-producer/single-consumer byte rings,
+ * one for requests and one for responses. Messages are framed by a 32 bit
+ * length prefix and may wrap around the end of a ring. Positions only grow,
+ * a reader is woken up by a process-shared semaphore per complete message.
+ *
+ * The simulation creates (and finally removes) the segment, the worker process
+ * attaches to it by name. Each ring must only be written by one thread at a
+ * time, the caller has to serialize concurrent senders.
+ */
+class ExternalNcsChannel {
+
+public:
+    static const uint32_t MAGIC = 0x4e435357; // "NCSW"
+    static const uint32_t VERSION = 1;
+
+    // create a new segment, which is unlinked again when the channel is deleted
+    static ExternalNcsChannel* create(const std::string& name, const uint64_t ringSize);
+    // attach to an existing segment
+    static ExternalNcsChannel* open(const std::string& name);
+
+    virtual ~ExternalNcsChannel();
+
+    const std::string& getName() const { return name; };
+
+    // blocks for at most timeoutMs milliseconds (forever if negative), returns false on timeout
+    bool send(const ExternalNcsChannelDirection dir, const ExternalNcsMessage& msg, const long timeoutMs);
+    bool receive(const ExternalNcsChannelDirection dir, ExternalNcsMessage& msg, const long timeoutMs);
+
+protected:
+    struct Ring {
+        std::atomic<uint64_t> writePos;
+        std::atomic<uint64_t> readPos;
+        sem_t available;    // posted for each complete message
+        sem_t freed;        // posted whenever the reader consumed a message
+    };
+
+    struct Segment {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ringSize;
+        Ring rings[2];
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "ring positions in shared memory require lock-free atomics");
+
+    ExternalNcsChannel(const std::string& name, void * const mapping, const size_t mappingSize, const bool owner);
+
+    static size_t getHeaderSize();
+    uint8_t * ringData(const ExternalNcsChannelDirection dir) const;
+    void copyIn(const ExternalNcsChannelDirection dir, uint64_t pos, const void * src, size_t len);
+    void copyOut(const ExternalNcsChannelDirection dir, uint64_t pos, void * dst, size_t len) const;
+
+    static bool wait(sem_t * const sem, const long timeoutMs);
+
+    const std::string name;
+    void * const mapping;
+    const size_t mappingSize;
+    Segment * const segment;
+    const bool owner;
+};
+
+#endif /* EXTERNALIMPL_EXTERNALNCSCHANNEL_H_ */
@@ -0,0 +1,316 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ExternalNcsImpl.h"
+
+#include <cmath>
+#include <thread>
+
+Define_Module(ExternalNcsImpl);
+
+
+ExternalNcsImpl::~ExternalNcsImpl() {
+    ExternalWorkerPool::release(pool);
+}
+
+void ExternalNcsImpl::initializeNcs(NcsContext * const context) {
+    ASSERT(context);
+
+    this->context = context;
+    parameters = context->getParameters();
+    signals = context->getSignals();
+
+    const int numWorkerProcesses = par("numWorkerProcesses").intValue();
+    const int64_t ringSize = par("ringSize").intValue();
+    const double timeout = par("callTimeout").doubleValue();
+
+    if (numWorkerProcesses < 0) {
+        error("numWorkerProcesses must not be negative");
+    }
+
+    if (ringSize <= 0) {
+        error("ringSize must be positive");
+    }
+
+    callTimeout = (timeout > 0) ? std::lround(timeout * 1000) : -1;
+
+    const unsigned int numWorkers = (numWorkerProcesses > 0) ? numWorkerProcesses : std::max(1u, std::thread::hardware_concurrency());
+
+    pool = ExternalWorkerPool::acquire(par("workerCommand").stdstringValue(), numWorkers, ringSize);
+
+    ExternalNcsMessage req;
+    ExternalNcsMessage resp;
+
+    prepareRequest(req, ENCC_INITIALIZE, SIMTIME_ZERO);
+
+    req.put<int64_t>(std::max((int64_t) 0, (parameters->simTimeLimit - parameters->startupDelay).inUnit(SIMTIME_PS)));
+    req.putString(parameters->configFile->stdstringValue());
+
+    const auto entries = getConfigEntries();
+
+    req.put<uint32_t>(entries.size());
+
+    for (auto &entry : entries) {
+        req.putString(entry.first);
+        req.putString(entry.second);
+    }
+
+    call(req, resp);
+
+    controlPeriod = SimTime(resp.get<int64_t>(), SIMTIME_PS);
+    plantPeriod = SimTime(resp.get<int64_t>(), SIMTIME_PS);
+
+    if (controlPeriod <= SIMTIME_ZERO || plantPeriod <= SIMTIME_ZERO) {
+        error("External NCS worker reported invalid periods");
+    }
+}
+
+void ExternalNcsImpl::finishNcs() {
+    ExternalNcsMessage req;
+    ExternalNcsMessage resp;
+
+    prepareRequest(req, ENCC_FINALIZE, simTime() - parameters->startupDelay);
+
+    call(req, resp);
+
+    context->recordScalar("total_control_costs", resp.get<double>());
+
+    const uint32_t scalars = resp.get<uint32_t>();
+
+    for (uint32_t i = 0; i < scalars; i++) {
+        const std::string name = resp.getString();
+
+        context->recordScalar(name.c_str(), resp.get<double>());
+    }
+}
+
+const simtime_t& ExternalNcsImpl::getPlantPeriod() {
+    return plantPeriod;
+}
+
+const simtime_t& ExternalNcsImpl::getControlPeriod() {
+    return controlPeriod;
+}
+
+void ExternalNcsImpl::doPlantStep(const simtime_t& ncsTime, NcsContext::NcsPlantStepResult * const result) {
+    doPlantSteps(ncsTime, 1, result);
+}
+
+void ExternalNcsImpl::doPlantSteps(const simtime_t& from, const unsigned long count, NcsContext::NcsPlantStepResult * const result) {
+    ASSERT(result);
+
+    ExternalNcsMessage req;
+    ExternalNcsMessage resp;
+
+    // coalesced plant steps cost a single round trip
+    prepareRequest(req, ENCC_PLANT_STEPS, from);
+    req.put<uint64_t>(count);
+
+    call(req, resp);
+
+    result->plantStateAdmissible = resp.get<uint8_t>() != 0;
+}
+
+void ExternalNcsImpl::computeControlStep(const simtime_t& ncsTime) {
+    // may run on a worker thread, thus no access to the simulation kernel here
+    ExternalNcsMessage req;
+
+    prepareRequest(req, ENCC_CONTROL_STEP, ncsTime);
+
+    controlStepTime = ncsTime;
+    controlStepComputed = true;
+    controlStepError.clear();
+
+    try {
+        pool->call(parameters->ncsId, req, controlStepResponse, callTimeout);
+    } catch (const std::exception& e) {
+        controlStepError = e.what();
+    }
+}
+
+void ExternalNcsImpl::doControlStep(const simtime_t& ncsTime, NcsContext::NcsControlStepResult * const result) {
+    ASSERT(result);
+
+    // without concurrent steps, the request has not been issued yet
+    if (!controlStepComputed || controlStepTime != ncsTime) {
+        computeControlStep(ncsTime);
+    }
+
+    controlStepComputed = false;
+
+    if (!controlStepError.empty()) {
+        error("External NCS worker failed for NCS with id %d: %s", parameters->ncsId, controlStepError.c_str());
+    }
+
+    ExternalNcsMessage &resp = controlStepResponse;
+
+    result->controllerStateAdmissible = resp.get<uint8_t>() != 0;
+    reportedQoC = resp.get<double>();
+
+    context->emit(signals->controlErrorSignal, resp.get<double>());
+    context->emit(signals->estControlErrorSignal, resp.get<double>());
+    context->emit(signals->stageCostsSignal, resp.get<double>());
+
+    // report observed delays
+    const simtime_t now = simTime();
+
+    for (auto evt : pktEvts) {
+        context->emit(evt.signal, now - evt.sent);
+    }
+
+    pktEvts.clear();
+
+    // prepare generated pkts to be sent to network
+    parsePkts(resp, result->pkts);
+}
+
+void ExternalNcsImpl::handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) {
+    // track received pkts to report observed delay
+    RcvdPktEvt evt;
+
+    evt.sent = ncsPkt.pkt->getCreationTime();
+
+    if (ncsPkt.dst == NCTXCI_ACTUATOR) {
+        evt.signal = signals->caObservedDelaySignal;
+    } else if (ncsPkt.dst == NCTXCI_CONTROLLER) {
+        if (!ncsPkt.isAck) {
+            // regular data packet from sensor to controller
+            evt.signal = signals->scObservedDelaySignal;
+        } else {
+            // ACK packet sent back from actuator
+            evt.signal = signals->acObservedDelaySignal;
+        }
+    }
+
+    pktEvts.push_back(evt);
+
+    // forward received pkt to the worker
+    ExternalNcsMessage req;
+    ExternalNcsMessage resp;
+    ByteArray &payload = ncsPkt.pkt->getByteArray();
+    const uint32_t payloadSize = payload.getDataArraySize();
+
+    prepareRequest(req, ENCC_HANDLE_PACKET, ncsTime);
+    req.put<uint8_t>(ncsPkt.src);
+    req.put<uint8_t>(ncsPkt.dst);
+    req.put<uint32_t>(payloadSize);
+    req.putBytes(payload.getDataPtr(), payloadSize);
+
+    call(req, resp);
+
+    ncsPkt.pktId = resp.get<uint64_t>();
+    ncsPkt.isAck = resp.get<uint8_t>() != 0;
+
+    // return potentially created response pkts
+    parsePkts(resp, replies);
+}
+
+void ExternalNcsImpl::prepareRequest(ExternalNcsMessage& req, const ExternalNcsCall call, const simtime_t& ncsTime) {
+    req.clear();
+    req.put<uint32_t>(call);
+    req.put<int32_t>(parameters->ncsId);
+    req.put<int64_t>(ncsTime.inUnit(SIMTIME_PS));
+}
+
+void ExternalNcsImpl::call(const ExternalNcsMessage& req, ExternalNcsMessage& resp) {
+    try {
+        pool->call(parameters->ncsId, req, resp, callTimeout);
+    } catch (const std::exception& e) {
+        error("External NCS worker failed for NCS with id %d: %s", parameters->ncsId, e.what());
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> ExternalNcsImpl::getConfigEntries() {
+    std::vector<std::pair<std::string, std::string>> result;
+
+    // the generic NCS configuration, empty strings and negative values are unset
+    cPar * const pars[] = {
+        parameters->controllerClassName,
+        parameters->filterClassName,
+        parameters->networkType,
+        parameters->controlSequenceLength,
+        parameters->maxMeasDelay,
+        parameters->mpcHorizon,
+        parameters->controlErrorWindowSize
+    };
+
+    for (cPar * const par : pars) {
+        if (par->getType() == cPar::STRING) {
+            if (!par->stdstringValue().empty()) {
+                result.push_back(std::make_pair(par->getName(), par->stdstringValue()));
+            }
+        } else if (par->doubleValue() >= 0) {
+            result.push_back(std::make_pair(par->getName(), std::to_string(par->doubleValue())));
+        }
+    }
+
+    // workers draw random numbers from their own generators, seeded reproducibly
+    result.push_back(std::make_pair("seed", std::to_string(intrand(INT32_MAX))));
+
+    // additional worker specific configuration, overrides the entries above
+    cStringTokenizer tokens(par("workerConfig").stringValue());
+
+    while (tokens.hasMoreTokens()) {
+        const std::string token = tokens.nextToken();
+        const size_t sep = token.find('=');
+
+        if (sep == std::string::npos || sep == 0) {
+            error("Invalid workerConfig entry '%s', expected key=value", token.c_str());
+        }
+
+        result.push_back(std::make_pair(token.substr(0, sep), token.substr(sep + 1)));
+    }
+
+    return result;
+}
+
+void ExternalNcsImpl::parsePkts(ExternalNcsMessage& resp, std::vector<NcsContext::NcsPkt>& ncsPkts) {
+    const uint32_t count = resp.get<uint32_t>();
+
+    ncsPkts.resize(count);
+
+    for (auto &ncsPkt : ncsPkts) {
+        const uint8_t src = resp.get<uint8_t>();
+        const uint8_t dst = resp.get<uint8_t>();
+
+        if (src >= NCTXCI_COUNT || dst >= NCTXCI_COUNT) {
+            error("External NCS worker created packet with invalid source or destination");
+        }
+
+        ncsPkt.src = static_cast<NcsContextComponentIndex>(src);
+        ncsPkt.dst = static_cast<NcsContextComponentIndex>(dst);
+        ncsPkt.pktId = resp.get<uint64_t>();
+        ncsPkt.isAck = resp.get<uint8_t>() != 0;
+
+        const uint32_t byteLength = resp.get<uint32_t>();
+        const uint32_t dataSize = resp.get<uint32_t>();
+        const uint8_t * const data = resp.getBytes(dataSize);
+
+        RawPacket * const rawPkt = new RawPacket();
+
+        rawPkt->setByteLength(std::max(byteLength, dataSize));
+        rawPkt->setDataFromBuffer(data, dataSize);
+
+        ncsPkt.pkt = rawPkt;
+    }
+}
+
+void ExternalNcsImpl::initialize() {
+    // nothing to do, set up by initializeNcs()
+}
+
+void ExternalNcsImpl::handleMessage(cMessage * const msg) {
+    error("ExternalNcsImpl received unexpected message");
+}
@@ -0,0 +1,100 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef EXTERNALIMPL_EXTERNALNCSIMPL_H_
+#define EXTERNALIMPL_EXTERNALNCSIMPL_H_
+
+#include <omnetpp.h>
+
+#include "NcsContext.h"
+#include "ExternalImpl/ExternalNcsChannel.h"
+#include "ExternalImpl/ExternalWorkerPool.h"
+
+using namespace omnetpp;
+
+/**
+ * NCS implementation forwarding all calls to a pool of local worker processes
+ * (see ExternalWorkerPool), e.g. the reference worker in ExternalImpl/worker.
+ *
+ * Control steps support concurrent computation: driven by an NcsTickScheduler
+ * with worker threads, the requests of all due NCS are in flight at the same
+ * time and computed by different worker processes.
+ */
+class ExternalNcsImpl : virtual public AbstractNcsImpl, public cSimpleModule {
+  public:
+
+    virtual ~ExternalNcsImpl();
+
+    virtual void initializeNcs(NcsContext * const context) override;
+    virtual void finishNcs() override;
+
+    virtual const simtime_t& getPlantPeriod() override;
+    virtual const simtime_t& getControlPeriod() override;
+
+    virtual void doPlantStep(const simtime_t& ncsTime, NcsContext::NcsPlantStepResult * const result) override;
+    virtual void doPlantSteps(const simtime_t& from, const unsigned long count, NcsContext::NcsPlantStepResult * const result) override;
+    virtual void doControlStep(const simtime_t& ncsTime, NcsContext::NcsControlStepResult * const result) override;
+    virtual void handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) override;
+
+    virtual bool supportsConcurrentSteps() override { return true; };
+    virtual void computeControlStep(const simtime_t& ncsTime) override;
+
+  protected:
+
+    struct RcvdPktEvt {
+        simtime_t sent;
+        simsignal_t signal;
+    };
+
+    NcsContext * context = nullptr;
+    const NcsContext::NcsParameters * parameters = nullptr;
+    const NcsContext::NcsSignals * signals = nullptr;
+    std::vector<RcvdPktEvt> pktEvts;
+
+    ExternalWorkerPool * pool = nullptr;
+    // maximum time to wait for a worker in ms, negative to wait forever
+    long callTimeout = -1;
+
+    simtime_t plantPeriod;
+    simtime_t controlPeriod;
+    /**
+     * Last QoC reported by the worker
+     */
+    double reportedQoC = 0;
+
+    /**
+     * Response of a control step requested by computeControlStep(), to be
+     * processed by the following doControlStep()
+     */
+    ExternalNcsMessage controlStepResponse;
+    simtime_t controlStepTime;
+    bool controlStepComputed = false;
+    // error of the computation, reported from the simulation thread
+    std::string controlStepError;
+
+  protected:
+
+    void prepareRequest(ExternalNcsMessage& req, const ExternalNcsCall call, const simtime_t& ncsTime);
+    void call(const ExternalNcsMessage& req, ExternalNcsMessage& resp);
+    std::vector<std::pair<std::string, std::string>> getConfigEntries();
+    void parsePkts(ExternalNcsMessage& resp, std::vector<NcsContext::NcsPkt>& ncsPkts);
+
+  protected:
+
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage * const msg) override;
+};
+
+#endif /* EXTERNALIMPL_EXTERNALNCSIMPL_H_ */
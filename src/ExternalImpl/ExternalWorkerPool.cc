@@ -0,0 +1,208 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ExternalWorkerPool.h"
+
+#include <omnetpp.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace omnetpp;
+
+extern char **environ;
+
+// interval for checking whether a worker is still alive while waiting for it
+static const long POLL_INTERVAL_MS = 100;
+// time granted to a worker for terminating after the shutdown request
+static const long SHUTDOWN_TIMEOUT_MS = 5000;
+
+ExternalWorkerPool * ExternalWorkerPool::instance = nullptr;
+unsigned int ExternalWorkerPool::references = 0;
+unsigned int ExternalWorkerPool::generation = 0;
+
+
+ExternalWorkerPool* ExternalWorkerPool::acquire(const std::string& command, const unsigned int numWorkers, const uint64_t ringSize) {
+    if (!instance) {
+        instance = new ExternalWorkerPool(command, numWorkers, ringSize);
+    } else if (instance->command != command || instance->size() != numWorkers || instance->ringSize != ringSize) {
+        throw cRuntimeError("All ExternalNcsImpl instances must use the same worker configuration");
+    }
+
+    references++;
+
+    return instance;
+}
+
+void ExternalWorkerPool::release(ExternalWorkerPool * const pool) {
+    if (!pool) {
+        return;
+    }
+
+    ASSERT(pool == instance && references > 0);
+
+    if (--references == 0) {
+        delete instance;
+
+        instance = nullptr;
+    }
+}
+
+ExternalWorkerPool::ExternalWorkerPool(const std::string& command, const unsigned int numWorkers, const uint64_t ringSize)
+        : command(command), ringSize(ringSize), workers(numWorkers) {
+    EV_STATICCONTEXT;
+
+    const std::string prefix = "/libncs_omnet." + std::to_string(getpid()) + "." + std::to_string(generation++) + ".";
+
+    try {
+        for (unsigned int i = 0; i < workers.size(); i++) {
+            spawn(workers[i], prefix + std::to_string(i));
+        }
+    } catch (...) {
+        for (auto &worker : workers) {
+            shutdown(worker);
+        }
+
+        throw;
+    }
+
+    EV_INFO << "started " << workers.size() << " external NCS workers: " << command << endl;
+}
+
+ExternalWorkerPool::~ExternalWorkerPool() {
+    for (auto &worker : workers) {
+        shutdown(worker);
+    }
+}
+
+void ExternalWorkerPool::spawn(Worker& worker, const std::string& shmName) {
+    try {
+        worker.channel = ExternalNcsChannel::create(shmName, ringSize);
+    } catch (const std::exception& e) {
+        throw cRuntimeError("Unable to set up external NCS worker: %s", e.what());
+    }
+
+    std::vector<std::string> args = cStringTokenizer(command.c_str()).asVector();
+
+    if (args.empty()) {
+        throw cRuntimeError("No external NCS worker command given");
+    }
+
+    args.push_back(shmName);
+
+    std::vector<char *> argv;
+
+    for (auto &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+
+    argv.push_back(nullptr);
+
+    const int err = posix_spawnp(&worker.pid, argv[0], nullptr, nullptr, argv.data(), environ);
+
+    if (err != 0) {
+        worker.pid = -1;
+
+        throw cRuntimeError("Unable to start external NCS worker %s: %s", argv[0], std::strerror(err));
+    }
+}
+
+void ExternalWorkerPool::shutdown(Worker& worker) {
+    if (worker.pid > 0 && !worker.failed) {
+        ExternalNcsMessage req;
+
+        req.put<uint32_t>(ENCC_SHUTDOWN);
+        req.put<int32_t>(-1);
+        req.put<int64_t>(0);
+
+        worker.channel->send(ENCD_REQUEST, req, SHUTDOWN_TIMEOUT_MS);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SHUTDOWN_TIMEOUT_MS);
+
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (waitpid(worker.pid, nullptr, WNOHANG) != 0) {
+                worker.pid = -1; // terminated and reaped
+
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS / 10));
+        }
+    }
+
+    // make sure no process is left behind
+    if (worker.pid > 0) {
+        kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, nullptr, 0);
+
+        worker.pid = -1;
+    }
+
+    delete worker.channel;
+
+    worker.channel = nullptr;
+}
+
+void ExternalWorkerPool::checkAlive(Worker& worker) {
+    int status;
+
+    if (waitpid(worker.pid, &status, WNOHANG) == worker.pid) {
+        worker.pid = -1;
+        worker.failed = true;
+
+        throw std::runtime_error("external NCS worker terminated unexpectedly (status " + std::to_string(status) + ")");
+    }
+}
+
+void ExternalWorkerPool::call(const int ncsId, const ExternalNcsMessage& req, ExternalNcsMessage& resp, const long timeoutMs) {
+    Worker &worker = workers[ncsId % workers.size()];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.failed) {
+        throw std::runtime_error("external NCS worker is not available anymore");
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    auto checkTimeout = [&]() {
+        if (timeoutMs >= 0 && std::chrono::steady_clock::now() > deadline) {
+            // a late response would be mistaken for the next one
+            worker.failed = true;
+
+            throw std::runtime_error("timeout while waiting for external NCS worker");
+        }
+    };
+
+    while (!worker.channel->send(ENCD_REQUEST, req, POLL_INTERVAL_MS)) {
+        checkAlive(worker);
+        checkTimeout();
+    }
+
+    while (!worker.channel->receive(ENCD_RESPONSE, resp, POLL_INTERVAL_MS)) {
+        checkAlive(worker);
+        checkTimeout();
+    }
+
+    if (resp.get<uint32_t>() != 0) {
+        throw std::runtime_error(resp.getString());
+    }
+}
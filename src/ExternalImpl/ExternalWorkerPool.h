@@ -0,0 +1,80 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef EXTERNALIMPL_EXTERNALWORKERPOOL_H_
+#define EXTERNALIMPL_EXTERNALWORKERPOOL_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "ExternalImpl/ExternalNcsChannel.h"
+
+/**
+ * Pool of local worker processes serving ExternalNcsImpl instances. Each worker
+ * is connected by its own ExternalNcsChannel, NCS instances are distributed
+ * over the workers by their ncsId. Calls to different workers may be issued
+ * concurrently, calls to the same worker are serialized.
+ *
+ * The pool is shared by all ExternalNcsImpl instances of a simulation run and
+ * reference counted like the MATLAB runtime in MatlabContext.
+ */
+class ExternalWorkerPool {
+
+public:
+    // starts the pool on first use, later calls must request the same configuration
+    static ExternalWorkerPool* acquire(const std::string& command, const unsigned int numWorkers, const uint64_t ringSize);
+    static void release(ExternalWorkerPool * const pool);
+
+    unsigned int size() const { return workers.size(); };
+
+    /**
+     * Forwards the request to the worker responsible for ncsId and blocks until
+     * its response arrived, at most timeoutMs milliseconds (forever if negative).
+     * The response status is already consumed. Thread-safe and independent of
+     * the simulation kernel, errors are thrown as std::runtime_error.
+     */
+    void call(const int ncsId, const ExternalNcsMessage& req, ExternalNcsMessage& resp, const long timeoutMs);
+
+protected:
+    struct Worker {
+        ExternalNcsChannel * channel = nullptr;
+        pid_t pid = -1;
+        // a worker which timed out or died is not used again
+        bool failed = false;
+        std::mutex mutex;
+    };
+
+    ExternalWorkerPool(const std::string& command, const unsigned int numWorkers, const uint64_t ringSize);
+    virtual ~ExternalWorkerPool();
+
+    void spawn(Worker& worker, const std::string& shmName);
+    void shutdown(Worker& worker);
+    void checkAlive(Worker& worker);
+
+protected:
+    const std::string command;
+    const uint64_t ringSize;
+
+    std::vector<Worker> workers;
+
+    static ExternalWorkerPool * instance;
+    static unsigned int references;
+    static unsigned int generation;
+};
+
+#endif /* EXTERNALIMPL_EXTERNALWORKERPOOL_H_ */
@@ -0,0 +1,203 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "MockNcsLoop.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+static const double PS_PER_S = 1E12;
+
+
+MockNcsLoop::MockNcsLoop(const int ncsId, const std::map<std::string, std::string>& config) : ncsId(ncsId) {
+    controlPeriod = std::llround(getDouble(config, "tickerInterval", 0.01) * PS_PER_S);
+    plantPeriod = controlPeriod;
+
+    sensorPayload = getDouble(config, "sensorPayload", 300);
+    controllerPayload = getDouble(config, "controllerPayload", 350);
+    fillPackets = getDouble(config, "fillPackets", 0) != 0;
+
+    minPktDelay = std::llround(getDouble(config, "minPktDelay", 0.01) * PS_PER_S);
+    maxPktDelay = std::llround(getDouble(config, "maxPktDelay", 0.05) * PS_PER_S);
+    maxPktDelayUtility = getDouble(config, "maxPktDelayUtility", 0.68);
+    qocSmoothing = getDouble(config, "qocSmoothing", 0.1);
+    pktRate = getDouble(config, "pktRate", 1);
+    rateJitter = getDouble(config, "rateJitter", 0.15);
+    computeLoad = std::llround(getDouble(config, "computeLoad", 0) * 1E9);
+
+    rng.seed(static_cast<uint64_t>(getDouble(config, "seed", 0)) * 1000003 + ncsId);
+
+    if (controlPeriod <= 0) {
+        throw std::invalid_argument("tickerInterval must be positive");
+    }
+    if (sensorPayload < sizeof(uint64_t) || controllerPayload < sizeof(uint64_t)) {
+        throw std::invalid_argument("payloads must be large enough to hold a packet id");
+    }
+    if (minPktDelay > maxPktDelay) {
+        throw std::invalid_argument("minPktDelay must not exceed maxPktDelay");
+    }
+}
+
+bool MockNcsLoop::doPlantSteps(const int64_t, const uint64_t count) {
+    // the mocked plant never leaves the admissible state
+    plantSteps += count;
+
+    return true;
+}
+
+void MockNcsLoop::doControlStep(const int64_t ncsTime, ControlStepResult& result) {
+    emulateComputationLoad();
+
+    // controller packets which did not arrive in time are considered lost
+    for (auto it = sentPkts.begin(); it != sentPkts.end();) {
+        if (ncsTime - it->second > maxPktDelay) {
+            recentPkts++;
+            it = sentPkts.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    // update QoC based on the utility of packets received since the last step
+    if (recentPkts > 0) {
+        qoc = (1 - qocSmoothing) * qoc + qocSmoothing * recentUtility / recentPkts;
+
+        recentUtility = 0;
+        recentPkts = 0;
+    }
+
+    result.admissible = true;
+    result.reportedQoC = qoc;
+    result.controlError = 1 - qoc;
+    result.stageCosts = (1 - qoc) * (1 - qoc);
+    result.pkts.clear();
+
+    // send packets at the configured rate, jittered like in the OMNeT++ mock
+    std::uniform_real_distribution<double> threshold(1.0 - rateJitter, 1.0);
+
+    rateAccumulator = std::min(rateAccumulator + pktRate, 1.0 + (1 - rateJitter));
+
+    if (rateAccumulator > threshold(rng)) {
+        rateAccumulator -= 1;
+
+        result.pkts.resize(2);
+
+        createPkt(SENSOR, CONTROLLER, sensorPayload, result.pkts[0]);
+        createPkt(CONTROLLER, ACTUATOR, controllerPayload, result.pkts[1]);
+
+        sentPkts[result.pkts[1].pktId] = ncsTime;
+    }
+
+    totalControlCosts += result.stageCosts;
+    qocSum += qoc;
+    controlSteps++;
+}
+
+uint64_t MockNcsLoop::handlePacket(const int64_t ncsTime, const uint8_t dst, const uint8_t * const data, const size_t len) {
+    uint64_t pktId;
+
+    if (len < sizeof(pktId)) {
+        throw std::invalid_argument("received packet without packet id");
+    }
+
+    std::memcpy(&pktId, data, sizeof(pktId));
+
+    pktsReceived++;
+
+    if (dst == ACTUATOR) {
+        const auto it = sentPkts.find(pktId);
+
+        // late packets have already been accounted as lost
+        if (it != sentPkts.end()) {
+            recentUtility += computeUtilityForPkt(ncsTime - it->second);
+            recentPkts++;
+
+            sentPkts.erase(it);
+        }
+    }
+
+    return pktId;
+}
+
+std::map<std::string, double> MockNcsLoop::getStatistics() const {
+    std::map<std::string, double> result;
+
+    result["workerPlantSteps"] = plantSteps;
+    result["workerControlSteps"] = controlSteps;
+    result["workerPktsSent"] = pktsSent;
+    result["workerPktsReceived"] = pktsReceived;
+    result["workerAvgQoC"] = controlSteps > 0 ? qocSum / controlSteps : 0;
+
+    return result;
+}
+
+double MockNcsLoop::getDouble(const std::map<std::string, std::string>& config, const std::string& key, const double defaultValue) const {
+    const auto it = config.find(key);
+
+    if (it == config.end()) {
+        return defaultValue;
+    }
+
+    char * end;
+    const double result = std::strtod(it->second.c_str(), &end);
+
+    if (end == it->second.c_str() || *end != '\0') {
+        throw std::invalid_argument("invalid value for " + key + ": " + it->second);
+    }
+
+    return result;
+}
+
+double MockNcsLoop::computeUtilityForPkt(const int64_t delay) const {
+    if (delay <= minPktDelay) {
+        return 1;
+    } else if (delay > maxPktDelay) {
+        return 0;
+    }
+
+    // linear decrease from 1 to maxPktDelayUtility
+    const double x = static_cast<double>(delay - minPktDelay) / (maxPktDelay - minPktDelay);
+
+    return 1 - x * (1 - maxPktDelayUtility);
+}
+
+void MockNcsLoop::createPkt(const uint8_t src, const uint8_t dst, const uint32_t len, Pkt& pkt) {
+    pkt.src = src;
+    pkt.dst = dst;
+    pkt.pktId = pktCounter++;
+    pkt.isAck = false;
+    pkt.byteLength = len;
+    pkt.data.assign(fillPackets ? len : sizeof(pkt.pktId), 0);
+
+    std::memcpy(pkt.data.data(), &pkt.pktId, sizeof(pkt.pktId));
+
+    pktsSent++;
+}
+
+void MockNcsLoop::emulateComputationLoad() const {
+    if (computeLoad <= 0) {
+        return;
+    }
+
+    // busy wait instead of sleeping, the point is to occupy a core
+    const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(computeLoad);
+
+    while (std::chrono::steady_clock::now() < until) {
+        // spin
+    }
+}
@@ -0,0 +1,117 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef EXTERNALIMPL_WORKER_MOCKNCSLOOP_H_
+#define EXTERNALIMPL_WORKER_MOCKNCSLOOP_H_
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Control loop hosted by the reference worker process. It follows the ideas of
+ * CoCpnMockNcsImpl, but without any dependency on OMNeT++: the QoC is driven
+ * by the delay utility of received controller packets, packets are sent at a
+ * configurable (jittered) rate and an optional busy loop emulates expensive
+ * controller computations.
+ *
+ * All times are NCS times in ps, as exchanged with ExternalNcsImpl.
+ */
+class MockNcsLoop {
+
+public:
+    // indices as used by NcsContextComponentIndex
+    enum Component : uint8_t {
+        ACTUATOR = 0,
+        CONTROLLER,
+        SENSOR
+    };
+
+    struct Pkt {
+        uint8_t src;
+        uint8_t dst;
+        uint64_t pktId;
+        bool isAck;
+        uint32_t byteLength;
+        std::vector<uint8_t> data;
+    };
+
+    struct ControlStepResult {
+        bool admissible;
+        double reportedQoC;
+        double controlError;
+        double stageCosts;
+        std::vector<Pkt> pkts;
+    };
+
+    MockNcsLoop(const int ncsId, const std::map<std::string, std::string>& config);
+
+    int64_t getControlPeriod() const { return controlPeriod; };
+    int64_t getPlantPeriod() const { return plantPeriod; };
+
+    bool doPlantSteps(const int64_t from, const uint64_t count);
+    void doControlStep(const int64_t ncsTime, ControlStepResult& result);
+    // returns the id of the received packet
+    uint64_t handlePacket(const int64_t ncsTime, const uint8_t dst, const uint8_t * const data, const size_t len);
+
+    double getTotalControlCosts() const { return totalControlCosts; };
+    std::map<std::string, double> getStatistics() const;
+
+protected:
+    double getDouble(const std::map<std::string, std::string>& config, const std::string& key, const double defaultValue) const;
+    double computeUtilityForPkt(const int64_t delay) const;
+    void createPkt(const uint8_t src, const uint8_t dst, const uint32_t len, Pkt& pkt);
+    void emulateComputationLoad() const;
+
+protected:
+    const int ncsId;
+
+    int64_t controlPeriod;
+    int64_t plantPeriod;
+
+    uint32_t sensorPayload;
+    uint32_t controllerPayload;
+    bool fillPackets;
+
+    int64_t minPktDelay;
+    int64_t maxPktDelay;
+    double maxPktDelayUtility;
+    double qocSmoothing;
+    double pktRate;
+    double rateJitter;
+    // busy time per control step in ns
+    int64_t computeLoad;
+
+    std::mt19937_64 rng;
+
+    double qoc = 1;
+    double rateAccumulator = 0;
+    double recentUtility = 0;
+    unsigned long recentPkts = 0;
+    uint64_t pktCounter = 0;
+    // pktId --> NCS time the controller packet was sent
+    std::map<uint64_t, int64_t> sentPkts;
+
+    double totalControlCosts = 0;
+    double qocSum = 0;
+    uint64_t plantSteps = 0;
+    uint64_t controlSteps = 0;
+    uint64_t pktsSent = 0;
+    uint64_t pktsReceived = 0;
+};
+
+#endif /* EXTERNALIMPL_WORKER_MOCKNCSLOOP_H_ */
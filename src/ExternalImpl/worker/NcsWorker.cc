@@ -0,0 +1,214 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+//
+// Reference worker process for ExternalNcsImpl, hosting MockNcsLoop instances.
+//
+// Usage: ncs_worker <shared memory segment name>
+//
+// The name is appended by the simulation when starting the worker. The worker
+// serves requests until it is shut down or the simulation process vanished.
+//
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "ExternalImpl/ExternalNcsChannel.h"
+#include "MockNcsLoop.h"
+
+// interval for checking whether the simulation process is still alive
+static const long POLL_INTERVAL_MS = 1000;
+
+static std::map<int, std::unique_ptr<MockNcsLoop>> loops;
+
+
+static MockNcsLoop& getLoop(const int ncsId) {
+    const auto it = loops.find(ncsId);
+
+    if (it == loops.end()) {
+        throw std::runtime_error("NCS " + std::to_string(ncsId) + " has not been initialized");
+    }
+
+    return *it->second;
+}
+
+static void putPkts(ExternalNcsMessage& msg, const std::vector<MockNcsLoop::Pkt>& pkts) {
+    msg.put<uint32_t>(pkts.size());
+
+    for (const auto &pkt : pkts) {
+        msg.put<uint8_t>(pkt.src);
+        msg.put<uint8_t>(pkt.dst);
+        msg.put<uint64_t>(pkt.pktId);
+        msg.put<uint8_t>(pkt.isAck);
+        msg.put<uint32_t>(pkt.byteLength);
+        msg.put<uint32_t>(pkt.data.size());
+        msg.putBytes(pkt.data.data(), pkt.data.size());
+    }
+}
+
+static void handleRequest(const uint32_t call, const int ncsId, const int64_t ncsTime, ExternalNcsMessage& req, ExternalNcsMessage& resp) {
+    switch (call) {
+    case ENCC_INITIALIZE: {
+        req.get<int64_t>(); // maxSimTime, not required by the mock
+        req.getString(); // configFile, not required by the mock
+
+        std::map<std::string, std::string> config;
+        const uint32_t entries = req.get<uint32_t>();
+
+        for (uint32_t i = 0; i < entries; i++) {
+            const std::string key = req.getString();
+
+            config[key] = req.getString();
+        }
+
+        std::unique_ptr<MockNcsLoop> loop(new MockNcsLoop(ncsId, config));
+
+        resp.put<int64_t>(loop->getControlPeriod());
+        resp.put<int64_t>(loop->getPlantPeriod());
+
+        loops[ncsId] = std::move(loop);
+        } break;
+    case ENCC_PLANT_STEPS: {
+        const uint64_t count = req.get<uint64_t>();
+
+        resp.put<uint8_t>(getLoop(ncsId).doPlantSteps(ncsTime, count));
+        } break;
+    case ENCC_CONTROL_STEP: {
+        MockNcsLoop::ControlStepResult result;
+
+        getLoop(ncsId).doControlStep(ncsTime, result);
+
+        resp.put<uint8_t>(result.admissible);
+        resp.put<double>(result.reportedQoC);
+        resp.put<double>(result.controlError);
+        resp.put<double>(result.controlError); // estimated control error, the mock knows the exact one
+        resp.put<double>(result.stageCosts);
+        putPkts(resp, result.pkts);
+        } break;
+    case ENCC_HANDLE_PACKET: {
+        req.get<uint8_t>(); // src
+        const uint8_t dst = req.get<uint8_t>();
+        const uint32_t len = req.get<uint32_t>();
+        const uint8_t * const data = req.getBytes(len);
+
+        resp.put<uint64_t>(getLoop(ncsId).handlePacket(ncsTime, dst, data, len));
+        resp.put<uint8_t>(false); // the mock does not acknowledge packets
+        putPkts(resp, std::vector<MockNcsLoop::Pkt>());
+        } break;
+    case ENCC_FINALIZE: {
+        const MockNcsLoop &loop = getLoop(ncsId);
+        const std::map<std::string, double> stats = loop.getStatistics();
+
+        resp.put<double>(loop.getTotalControlCosts());
+        resp.put<uint32_t>(stats.size());
+
+        for (const auto &entry : stats) {
+            resp.putString(entry.first);
+            resp.put<double>(entry.second);
+        }
+
+        loops.erase(ncsId);
+        } break;
+    default:
+        throw std::runtime_error("unknown call " + std::to_string(call));
+    }
+}
+
+// returns false if the simulation is gone while waiting for ring space
+static bool sendResponse(ExternalNcsChannel& channel, const ExternalNcsMessage& resp, const pid_t parent) {
+    while (!channel.send(ENCD_RESPONSE, resp, POLL_INTERVAL_MS)) {
+        if (getppid() != parent) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <shared memory segment name>\n", argv[0]);
+
+        return 1;
+    }
+
+    const pid_t parent = getppid();
+    std::unique_ptr<ExternalNcsChannel> channel;
+
+    try {
+        channel.reset(ExternalNcsChannel::open(argv[1]));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+
+        return 1;
+    }
+
+    ExternalNcsMessage req;
+    ExternalNcsMessage resp;
+
+    while (true) {
+        if (!channel->receive(ENCD_REQUEST, req, POLL_INTERVAL_MS)) {
+            if (getppid() != parent) {
+                break; // simulation is gone
+            }
+
+            continue;
+        }
+
+        const uint32_t call = req.get<uint32_t>();
+        const int ncsId = req.get<int32_t>();
+        const int64_t ncsTime = req.get<int64_t>();
+
+        if (call == ENCC_SHUTDOWN) {
+            break;
+        }
+
+        resp.clear();
+
+        try {
+            resp.put<uint32_t>(0);
+
+            handleRequest(call, ncsId, ncsTime, req, resp);
+        } catch (const std::exception& e) {
+            resp.clear();
+            resp.put<uint32_t>(1);
+            resp.putString(e.what());
+        }
+
+        bool delivered;
+
+        try {
+            delivered = sendResponse(*channel, resp, parent);
+        } catch (const std::length_error& e) {
+            // response does not fit into the ring, report that instead
+            resp.clear();
+            resp.put<uint32_t>(1);
+            resp.putString(e.what());
+
+            delivered = sendResponse(*channel, resp, parent);
+        }
+
+        if (!delivered) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
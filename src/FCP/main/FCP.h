@@ -2,11 +2,13 @@
 #define __LIBNCS_OMNET_FCP_H
 
 #include <map>
+#include <unordered_map>
 
 #include <inet/common/INETDefs.h>
 
 #include <inet/networklayer/common/L3Address.h>
 #include "FCP/contract/FCPCommand_m.h"
+#include "util/SocketTable.h"
 
 class FCPPacket;
 class FCPConnection;
@@ -36,6 +38,26 @@ class INET_API FCP : public cSimpleModule{
             else
                 return localPort < b.localPort;
         }
+
+        inline bool operator==(const SocketPair& b) const
+        {
+            return remoteAddr == b.remoteAddr && localAddr == b.localAddr
+                    && remotePort == b.remotePort && localPort == b.localPort;
+        }
+    };
+
+    struct SocketPairHash
+    {
+        size_t operator()(const SocketPair& s) const
+        {
+            L3AddressHash addrHash;
+            size_t h = addrHash(s.remoteAddr);
+
+            h = L3AddressHash::combine(h, addrHash(s.localAddr));
+            h = L3AddressHash::combine(h, static_cast<uint32_t>(s.remotePort));
+
+            return L3AddressHash::combine(h, static_cast<uint32_t>(s.localPort));
+        }
     };
 
     simsignal_t rateSignal;
@@ -57,7 +79,7 @@ class INET_API FCP : public cSimpleModule{
 
     protected:
         typedef std::map<int, FCPConnection *> FcpAppConnMap;
-        typedef std::map<SocketPair, FCPConnection *> FcpSocketConnMap;
+        typedef std::unordered_map<SocketPair, FCPConnection *, SocketPairHash> FcpSocketConnMap;
         FcpAppConnMap fcpAppConnectionMap;
         FcpSocketConnMap fcpSocketConnectionMap;
 
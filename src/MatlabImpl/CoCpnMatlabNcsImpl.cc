@@ -84,6 +84,7 @@ void CoCpnMatlabNcsImpl::applyTargetQoC() {
     ASSERT(mw_deviationFactor.NumberOfElements() == 1);
 
     rateDeviation = 1.0 / static_cast<double>(mw_deviationFactor);
+    rateFunctionChanged();
 
     emit(s_rateDeviation, rateDeviation);
 
@@ -182,17 +183,8 @@ void CoCpnMatlabNcsImpl::setConfigValues(mwArray &cfgStruct) {
 
     setNonnegDbl(cfgStruct, parameters->samplingInterval);
 
-    if (parameters->useSampledDelayProbs) {
-        NcsContext::NcsDelays delays = context->computeDelays();
-
-        setNonemptyDblVect(cfgStruct, parameters->scDelayProbs->getName(), delays.sc);
-
-        for (auto it = delays.ca.begin(); it != delays.ca.end(); it++) {
-            printf("%.2f, ", *it);
-        }
-        printf("\n");
-        setNonemptyDblVect(cfgStruct, parameters->caDelayProbs->getName(), delays.ca);
-    } else {
+    // sampled delay probabilities are set by updateDynamicConfigValues()
+    if (!parameters->useSampledDelayProbs) {
         setNonemptyDblVect(cfgStruct, parameters->scDelayProbs);
         setNonemptyDblVect(cfgStruct, parameters->caDelayProbs);
     }
@@ -207,3 +199,16 @@ void CoCpnMatlabNcsImpl::setConfigValues(mwArray &cfgStruct) {
 
     setNonemptyString(cfgStruct, parameters->translatorFile);
 }
+
+void CoCpnMatlabNcsImpl::updateDynamicConfigValues(mwArray &cfgStruct) {
+    MatlabNcsImpl::updateDynamicConfigValues(cfgStruct);
+
+    auto parameters = static_cast<const CoCpnNcsContext::CoCpnNcsParameters*>(this->parameters);
+
+    if (parameters->useSampledDelayProbs) {
+        NcsContext::NcsDelays delays = context->computeDelays();
+
+        setNonemptyDblVect(cfgStruct, parameters->scDelayProbs->getName(), delays.sc);
+        setNonemptyDblVect(cfgStruct, parameters->caDelayProbs->getName(), delays.ca);
+    }
+}
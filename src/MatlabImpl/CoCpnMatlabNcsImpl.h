@@ -58,6 +58,7 @@ class CoCpnMatlabNcsImpl : public AbstractCoCpnNcsImpl, public MatlabNcsImpl {
 
     virtual std::vector<const char *> getConfigFieldNames() override;
     virtual void setConfigValues(mwArray &cfgStruct) override;
+    virtual void updateDynamicConfigValues(mwArray &cfgStruct) override;
 
   protected:
 
@@ -46,7 +46,7 @@ void MatlabNcsImpl::initializeNcs(NcsContext * const context) {
     const mwArray mw_configFile(parameters->configFile->stringValue());
     const mwArray mw_maxSimTime(std::max((int64_t) 0, (parameters->simTimeLimit - parameters->startupDelay).inUnit(SIMTIME_PS)));
 
-    const mwArray mw_configStruct = createNcsConfigStruct();
+    const mwArray& mw_configStruct = getNcsConfigStruct();
 
     ncs_initialize(1, ncsHandle, mw_maxSimTime, mw_ncsId, mw_configStruct, mw_configFile);
 
@@ -126,8 +126,8 @@ void MatlabNcsImpl::doControlStep(const simtime_t& ncsTime, NcsContext::NcsContr
 //  mw_paramStruct("controllerDeadband", 1, 1).Set(value);
     // for now: re-use params of simulation configuration
     // may be functions evaluated by omnet to vary parameters during
-    // simulation run-time
-    mwArray mw_paramStruct = createNcsConfigStruct();
+    // simulation run-time, the struct is only rebuilt if required
+    const mwArray& mw_paramStruct = getNcsConfigStruct();
     mwArray mw_ncsPktList;
     mwArray mw_reportedQoc;
     mwArray mw_ncsStats;
@@ -161,7 +161,7 @@ void MatlabNcsImpl::doControlStep(const simtime_t& ncsTime, NcsContext::NcsContr
     parseMatlabPktList(mw_ncsPktList, result->pkts);
 }
 
-std::vector<NcsContext::NcsPkt> MatlabNcsImpl::handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt) {
+void MatlabNcsImpl::handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) {
     // track received pkts to report observed delay
     RcvdPktEvt evt;
 
@@ -189,11 +189,7 @@ std::vector<NcsContext::NcsPkt> MatlabNcsImpl::handlePacket(const simtime_t& ncs
     ncs_doHandlePacket(1, mw_ncsPktList, ncsHandle, mw_timestamp, mw_pkt);
 
     // return potentially created response pkts
-    std::vector<NcsContext::NcsPkt> result;
-
-    parseMatlabPktList(mw_ncsPktList, result);
-
-    return result;
+    parseMatlabPktList(mw_ncsPktList, replies);
 }
 
 void MatlabNcsImpl::updateControlPeriod(const simtime_t newControlPeriod) {
@@ -210,73 +206,74 @@ void MatlabNcsImpl::parseMatlabPktList(const mwArray& mw_ncsPktList, std::vector
 
     ncsPkts.resize(cpsPktCount);
 
-    if (cpsPktCount != 0) {
-        // mw_cpsPktList with packets to send to a certain node should be a
-        // cpsPktCount-by-1 cell array (column-vector like)
-        ASSERT(mw_ncsPktList.NumberOfDimensions() == 2);
-        ASSERT((size_t ) mw_ncsPktList.GetDimensions()(1) == cpsPktCount);
-        ASSERT((size_t ) mw_ncsPktList.GetDimensions()(2) == 1);
-        ASSERT(mw_ncsPktList.ClassID() == mxCELL_CLASS);
-
-        for (uint32_t pktNum = 0; pktNum < cpsPktCount; pktNum++) {
-            parseMatlabPkt(mw_ncsPktList(pktNum + 1), ncsPkts[pktNum]);
-        }
+    if (cpsPktCount == 0) {
+        return;
     }
-}
-
-void MatlabNcsImpl::parseMatlabPkt(const mwArray& mw_pkt, NcsContext::NcsPkt& ncsPkt) {
-    // transform the MATLAB NCS packet into an OMNeT++/INET RawPacket, wrapped into an NcsPkt
-
-    ASSERT(mw_pkt.NumberOfElements() == 1);
-
-    mwArray mw_src, mw_dst, mw_payload;
-
-    ncs_pktGetSrcAddr(1, mw_src, mw_pkt);
-    ncs_pktGetDstAddr(1, mw_dst, mw_pkt);
-    ncs_pktGetPayload(1, mw_payload, mw_pkt);
-
-    // the payload should be a byte stream (row vector like 1-by-n)
-    ASSERT(mw_payload.NumberOfDimensions() == 2);
-    ASSERT((size_t ) mw_payload.GetDimensions()(1) == 1);
-    ASSERT(mw_payload.ClassID() == mxUINT8_CLASS);
-
-    RawPacket* const rawPkt = new RawPacket();
-    ByteArray payloadArray;
-    uint8_t payloadBuf[mw_payload.NumberOfElements()];
-
-    mw_payload.GetData(payloadBuf, sizeof(payloadBuf));
-    payloadArray.setDataFromBuffer(payloadBuf, sizeof(payloadBuf));
-
-    rawPkt->setByteLength(sizeof(payloadBuf));
-    rawPkt->setByteArray(payloadArray);
 
-    const int srcIndex = mw_src;
-    const int dstIndex = mw_dst;
+    // mw_cpsPktList with packets to send to a certain node should be a
+    // cpsPktCount-by-1 cell array (column-vector like)
+    ASSERT(mw_ncsPktList.NumberOfDimensions() == 2);
+    ASSERT((size_t ) mw_ncsPktList.GetDimensions()(1) == cpsPktCount);
+    ASSERT((size_t ) mw_ncsPktList.GetDimensions()(2) == 1);
+    ASSERT(mw_ncsPktList.ClassID() == mxCELL_CLASS);
+
+    // obtain all packets as struct of arrays with a single MATLAB call:
+    // one element per packet for src, dst, id and isAck, the concatenated
+    // payloads (uint8 row vector) and cpsPktCount + 1 zero-based offsets
+    mwArray mw_src, mw_dst, mw_id, mw_isAck, mw_payloads, mw_offsets;
+
+    ncs_pktListToArrays(6, mw_src, mw_dst, mw_id, mw_isAck, mw_payloads, mw_offsets, mw_ncsPktList);
+
+    ASSERT((size_t ) mw_src.NumberOfElements() == cpsPktCount);
+    ASSERT((size_t ) mw_dst.NumberOfElements() == cpsPktCount);
+    ASSERT((size_t ) mw_id.NumberOfElements() == cpsPktCount);
+    ASSERT((size_t ) mw_isAck.NumberOfElements() == cpsPktCount);
+    ASSERT((size_t ) mw_offsets.NumberOfElements() == cpsPktCount + 1);
+    ASSERT(mw_payloads.ClassID() == mxUINT8_CLASS);
+
+    // GetData converts to the buffer type, buffers are reused across calls
+    PktListBuffers &buf = pktListBuffers;
+    const size_t payloadSize = mw_payloads.NumberOfElements();
+
+    buf.src.resize(cpsPktCount);
+    buf.dst.resize(cpsPktCount);
+    buf.id.resize(cpsPktCount);
+    buf.isAck.resize(cpsPktCount);
+    buf.offsets.resize(cpsPktCount + 1);
+    buf.payloads.resize(payloadSize);
+
+    mw_src.GetData(buf.src.data(), cpsPktCount);
+    mw_dst.GetData(buf.dst.data(), cpsPktCount);
+    mw_id.GetData(buf.id.data(), cpsPktCount);
+    mw_isAck.GetData(buf.isAck.data(), cpsPktCount);
+    mw_offsets.GetData(buf.offsets.data(), cpsPktCount + 1);
+
+    if (payloadSize > 0) {
+        mw_payloads.GetData(buf.payloads.data(), payloadSize);
+    }
 
-    ASSERT(srcIndex < NCTXCI_COUNT);
-    ASSERT(dstIndex < NCTXCI_COUNT);
+    ASSERT(buf.offsets[cpsPktCount] == payloadSize);
 
-    ncsPkt.src = static_cast<NcsContextComponentIndex>(srcIndex);
-    ncsPkt.dst = static_cast<NcsContextComponentIndex>(dstIndex);
-    ncsPkt.pktId = getMatlabPktId(mw_pkt);
-    ncsPkt.isAck = matlabPktIsAck(mw_pkt);
-    ncsPkt.pkt = rawPkt;
-}
+    for (size_t pktNum = 0; pktNum < cpsPktCount; pktNum++) {
+        NcsContext::NcsPkt &ncsPkt = ncsPkts[pktNum];
+        const uint64_t offset = buf.offsets[pktNum];
+        const uint64_t length = buf.offsets[pktNum + 1] - offset;
 
-uint64_t MatlabNcsImpl::getMatlabPktId(const mwArray& mw_pkt) {
-    mwArray mw_id;
+        ASSERT(buf.offsets[pktNum + 1] >= offset);
+        ASSERT(buf.src[pktNum] < NCTXCI_COUNT);
+        ASSERT(buf.dst[pktNum] < NCTXCI_COUNT);
 
-    ncs_pktGetId(1, mw_id, mw_pkt);
+        RawPacket* const rawPkt = new RawPacket();
 
-    return static_cast<uint64_t>(mw_id);
-}
+        rawPkt->setByteLength(length);
+        rawPkt->setDataFromBuffer(buf.payloads.data() + offset, length);
 
-bool MatlabNcsImpl::matlabPktIsAck(const mwArray& mw_pkt) {
-    mwArray mw_isAck;
-
-    ncs_pktIsAck(1, mw_isAck, mw_pkt);
-
-    return static_cast<bool>(mw_isAck);
+        ncsPkt.src = static_cast<NcsContextComponentIndex>(buf.src[pktNum]);
+        ncsPkt.dst = static_cast<NcsContextComponentIndex>(buf.dst[pktNum]);
+        ncsPkt.pktId = buf.id[pktNum];
+        ncsPkt.isAck = buf.isAck[pktNum] != 0;
+        ncsPkt.pkt = rawPkt;
+    }
 }
 
 mwArray MatlabNcsImpl::ncsPktToMatlabPkt(NcsContext::NcsPkt& pkt) {
@@ -293,15 +290,18 @@ mwArray MatlabNcsImpl::ncsPktToMatlabPkt(NcsContext::NcsPkt& pkt) {
     mwArray mw_src(pkt.src);
     mwArray mw_dst(pkt.dst);
     mwArray mw_pkt;
+    mwArray mw_id;
 
-    ncs_pktCreate(1, mw_pkt, mw_src, mw_dst, mw_payload);
+    // the id of the created packet is returned along with it
+    ncs_pktCreate(2, mw_pkt, mw_id, mw_src, mw_dst, mw_payload);
 
-    pkt.pktId = getMatlabPktId(mw_pkt);
+    pkt.pktId = static_cast<uint64_t>(mw_id);
 
     return mw_pkt;
 }
 
 void MatlabNcsImpl::recordPlantStatistics(mwArray& plantStatistics) {
+    std::vector<simtime_t> times;
 
     for (int i = 0; i < plantStatistics.NumberOfFields(); ++i) {
         const mwString f = plantStatistics.GetFieldName(i);
@@ -309,22 +309,14 @@ void MatlabNcsImpl::recordPlantStatistics(mwArray& plantStatistics) {
         const mwArray currStat = plantStatistics(statName.c_str(), 1, 1);
 
         const mwArray dims = currStat.GetDimensions();
-        const uint32_t numRows = dims(1);
-
-        auto statsVecs = this->createNumericStatisticsOutVectors(statName, numRows);
-
         const uint32_t numElements = dims(2);
-        for (uint32_t i = 0; i < numElements; ++i) {
-            const simtime_t time = this->plantPeriod * i + parameters->startupDelay;
 
-            for (uint32_t j = 0; j < numRows; ++j) {
-                statsVecs[j]->recordWithTimestamp(time, (double) currStat(j + 1, i + 1));
-            }
+        // plant statistics are sampled once per plant step
+        for (uint32_t k = times.size(); k < numElements; ++k) {
+            times.push_back(this->plantPeriod * k + parameters->startupDelay);
         }
-        for (uint32_t i = 0; i < numRows; ++i) {
-            delete statsVecs[i];
-        }
-        statsVecs.clear();
+
+        recordNumericStatistic(statName, currStat, times.data());
     }
 }
 
@@ -338,6 +330,18 @@ void MatlabNcsImpl::recordControllerStatistics(mwArray& controllerStatistics) {
     ASSERT(timesDim == 1); // row vector
     ASSERT(controllerTimes.IsNumeric());
 
+    // fetch all controller times at once and convert them to simtimes
+    std::vector<double> timesBuf(numTimes);
+    std::vector<simtime_t> simTimes(numTimes);
+
+    if (numTimes > 0) {
+        controllerTimes.GetData(timesBuf.data(), numTimes);
+    }
+
+    for (uint32_t i = 0; i < numTimes; ++i) {
+        simTimes[i] = timesBuf[i] + parameters->startupDelay;
+    }
+
     for (int i = 0; i < controllerStatistics.NumberOfFields(); ++i) {
         const mwString f = controllerStatistics.GetFieldName(i);
         const std::string statName(static_cast<const char*>(f));
@@ -345,45 +349,66 @@ void MatlabNcsImpl::recordControllerStatistics(mwArray& controllerStatistics) {
             const mwArray currStat = controllerStatistics(statName.c_str(), 1, 1);
 
             const mwArray dims = currStat.GetDimensions();
-            const uint32_t numRows = dims(1);
             const uint32_t numElements = dims(2);
-            auto statsVecs = this->createNumericStatisticsOutVectors(statName, numRows);
 
             // skip the first time index if number of elements is less than number of times
-            // indices start at 1 when accessing matlab arrays
-            uint32_t timeIdx = (numElements == numTimes-1) ? 2 : 1;
-            for (uint32_t i = 0; i < numElements; ++i) {
-                const simtime_t time = (double) controllerTimes(timeIdx++) + parameters->startupDelay;
-
-                for (uint32_t j = 0; j < numRows; ++j) {
-                    statsVecs[j]->recordWithTimestamp(time, (double) currStat(j + 1, i + 1));
-                }
-            }
-            for (uint32_t i = 0; i < numRows; ++i) {
-                delete statsVecs[i];
-            }
-            statsVecs.clear();
+            const uint32_t timeOffset = (numElements == numTimes-1) ? 1 : 0;
+
+            ASSERT(numElements + timeOffset <= numTimes);
+
+            recordNumericStatistic(statName, currStat, simTimes.data() + timeOffset);
         }
 
     }
 }
 
-const std::vector<cOutVector*> MatlabNcsImpl::createNumericStatisticsOutVectors(const std::string& statName, uint32_t numComponents) {
+void MatlabNcsImpl::recordNumericStatistic(const std::string& statName, const mwArray& stat, const simtime_t * const times) {
+    const mwArray dims = stat.GetDimensions();
+    const uint32_t numRows = dims(1);
+    const uint32_t numElements = dims(2);
+    const size_t count = static_cast<size_t>(numRows) * numElements;
+
+    if (count == 0) {
+        return;
+    }
+
+    // copy the whole statistic with a single call, MATLAB arrays are stored
+    // column-major, i.e. element (j, i) is located at index i * numRows + j
+    statisticsBuffer.resize(count);
+    stat.GetData(statisticsBuffer.data(), count);
 
-    if (numComponents == 1) {
-        auto vec = new cOutVector(statName.c_str());
-        vec->setType(cOutVector::TYPE_DOUBLE);
+    // write one row after the other, each into its own vector
+    for (uint32_t j = 0; j < numRows; ++j) {
+        const std::string name = (numRows == 1) ? statName : statName + "(" + std::to_string(j+1) + ")";
+        cOutVector vec(name.c_str());
+        const double * value = statisticsBuffer.data() + j;
 
-        return std::vector<cOutVector*> ({vec});
+        vec.setType(cOutVector::TYPE_DOUBLE);
+
+        for (uint32_t i = 0; i < numElements; ++i, value += numRows) {
+            vec.recordWithTimestamp(times[i], *value);
+        }
     }
+}
+
+void MatlabNcsImpl::handleNcsParameterChange(const char * parname) {
+    invalidateNcsConfig();
+}
 
-    auto result = std::vector<cOutVector*> ();
-    for (uint32_t i = 0; i< numComponents; ++i) {
-        auto vec = new cOutVector((statName + "(" + std::to_string(i+1) + ")").c_str());
-        vec->setType(cOutVector::TYPE_DOUBLE);
-        result.push_back(vec);
+void MatlabNcsImpl::invalidateNcsConfig() {
+    ncsConfigValid = false;
+}
+
+const mwArray& MatlabNcsImpl::getNcsConfigStruct() {
+    if (!ncsConfigValid || ncsConfigVolatile) {
+        ncsConfigVolatile = false;
+        ncsConfigStruct = createNcsConfigStruct();
+        ncsConfigValid = true;
     }
-    return result;
+
+    updateDynamicConfigValues(ncsConfigStruct);
+
+    return ncsConfigStruct;
 }
 
 mwArray MatlabNcsImpl::createNcsConfigStruct() {
@@ -420,29 +445,43 @@ void MatlabNcsImpl::setConfigValues(mwArray &cfgStruct) {
     setNonnegDbl(cfgStruct, parameters->controlErrorWindowSize);
 }
 
+void MatlabNcsImpl::trackConfigPar(cPar * const par) {
+    if (par->isVolatile() && par->isExpression()) {
+        ncsConfigVolatile = true;
+    }
+}
+
 void MatlabNcsImpl::testNonnegBool(std::vector<const char *> &fieldNames, cPar * const par) {
     testNonnegLong(fieldNames, par);
 }
 
 void MatlabNcsImpl::testNonnegLong(std::vector<const char *> &fieldNames, cPar * const par) {
+    trackConfigPar(par);
+
     if (par->intValue() >= 0) {
         fieldNames.push_back(par->getName());
     }
 }
 
 void MatlabNcsImpl::testPositiveLong(std::vector<const char *> &fieldNames, cPar * const par) {
+    trackConfigPar(par);
+
     if (par->intValue() > 0) {
         fieldNames.push_back(par->getName());
     }
 }
 
 void MatlabNcsImpl::testNonnegDbl(std::vector<const char *> &fieldNames, cPar * const par) {
+    trackConfigPar(par);
+
     if (par->doubleValue() >= 0) {
         fieldNames.push_back(par->getName());
     }
 }
 
 void MatlabNcsImpl::testNonemptyDblVect(std::vector<const char *> &fieldNames, cPar * const par) {
+    trackConfigPar(par);
+
     if (par->stdstringValue().length() > 0) {
         cStringTokenizer tokens(par->stringValue());
         const std::vector<double> dbls = tokens.asDoubleVector();
@@ -455,6 +494,8 @@ void MatlabNcsImpl::testNonemptyDblVect(std::vector<const char *> &fieldNames, c
 }
 
 void MatlabNcsImpl::testNonemptyString(std::vector<const char *> &fieldNames, cPar * const par) {
+    trackConfigPar(par);
+
     if (par->stdstringValue().length() > 0) {
         fieldNames.push_back(par->getName());
     }
@@ -48,7 +48,13 @@ class MatlabNcsImpl: virtual public AbstractNcsImpl, public MatlabInitializer, p
 
     virtual void doPlantStep(const simtime_t& ncstTime, NcsContext::NcsPlantStepResult * const result) override;
     virtual void doControlStep(const simtime_t& ncstTime, NcsContext::NcsControlStepResult * const result) override;
-    virtual std::vector<NcsContext::NcsPkt> handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt) override;
+    virtual void handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) override;
+    virtual void handleNcsParameterChange(const char * parname) override;
+
+    /**
+     * Forces the config struct to be rebuilt before the next control step.
+     */
+    void invalidateNcsConfig();
 
   protected:
 
@@ -79,24 +85,54 @@ class MatlabNcsImpl: virtual public AbstractNcsImpl, public MatlabInitializer, p
      * //TODO move to CoCPN-specific code?
      */
     double reportedQoC;
+    /**
+     * Config struct passed to MATLAB, built once and reused for all control steps
+     * until invalidated by a parameter change.
+     */
+    mwArray ncsConfigStruct;
+    bool ncsConfigValid = false;
+    /**
+     * Set while building the config struct if any of the used parameters is
+     * volatile and given by an expression, i.e. may change on each evaluation.
+     * The config struct is then rebuilt for each control step.
+     */
+    bool ncsConfigVolatile = false;
+
+    /**
+     * Buffers for unpacking packet lists obtained from MATLAB, kept to avoid
+     * reallocations on each control step.
+     */
+    struct PktListBuffers {
+        std::vector<mxUint8> src;
+        std::vector<mxUint8> dst;
+        std::vector<mxUint64> id;
+        std::vector<mxUint8> isAck;
+        std::vector<mxUint64> offsets;
+        std::vector<mxUint8> payloads;
+    };
+
+    PktListBuffers pktListBuffers;
+    // buffer for statistics obtained from MATLAB in finishNcs()
+    std::vector<double> statisticsBuffer;
 
   protected:
 
     void updateControlPeriod(const simtime_t newControlPeriod);
 
     void parseMatlabPktList(const mwArray& mw_ncsPktList, std::vector<NcsContext::NcsPkt> & ncsPkts);
-    void parseMatlabPkt(const mwArray& mw_pkt, NcsContext::NcsPkt& ncsPkt);
-    uint64_t getMatlabPktId(const mwArray& mw_pkt);
-    bool matlabPktIsAck(const mwArray& mw_pkt);
     mwArray ncsPktToMatlabPkt(NcsContext::NcsPkt& pkt);
 
     void recordPlantStatistics(mwArray& plantStatistics);
     void recordControllerStatistics(mwArray& controllerStatistics);
-    const std::vector<cOutVector*> createNumericStatisticsOutVectors(const std::string& statName, uint32_t numComponents);
+    void recordNumericStatistic(const std::string& statName, const mwArray& stat, const simtime_t * const times);
 
+    const mwArray& getNcsConfigStruct();
     mwArray createNcsConfigStruct();
     virtual std::vector<const char *> getConfigFieldNames();
     virtual void setConfigValues(mwArray &cfgStruct);
+    // values which have to be refreshed for each control step, even if the config struct is cached
+    virtual void updateDynamicConfigValues(mwArray &cfgStruct) { };
+    void trackConfigPar(cPar * const par);
     void testNonnegBool(std::vector<const char *> &fieldNames, cPar * const par);
     void testNonnegLong(std::vector<const char *> &fieldNames, cPar * const par);
     void testPositiveLong(std::vector<const char *> &fieldNames, cPar * const par);
@@ -179,6 +179,15 @@ void CoCpnMockNcsImpl::doPlantStep(const simtime_t& ncsTime, NcsContext::NcsPlan
     result->plantStateAdmissible = true;
 }
 
+void CoCpnMockNcsImpl::doPlantSteps(const simtime_t&, const unsigned long, NcsContext::NcsPlantStepResult * const result) {
+    result->plantStateAdmissible = true;
+}
+
+simtime_t CoCpnMockNcsImpl::getNextPlantWakeup(const simtime_t&) {
+    // there is no plant, plant steps can be deferred forever
+    return SIMTIME_MAX;
+}
+
 void CoCpnMockNcsImpl::doControlStep(const simtime_t& ncsTime, NcsContext::NcsControlStepResult * const result) {
     ASSERT(dynamic_cast<CoCpnNcsContext::CoCpnNcsControlStepResult*>(result));
 
@@ -325,7 +334,7 @@ void CoCpnMockNcsImpl::doControlStep(const simtime_t& ncsTime, NcsContext::NcsCo
     context->emit(signals->controlErrorSignal, actualQoC);
 }
 
-std::vector<NcsContext::NcsPkt> CoCpnMockNcsImpl::handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt) {
+void CoCpnMockNcsImpl::handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) {
     ncsPkt.isAck = false;
 
     // extract packet id
@@ -340,18 +349,48 @@ std::vector<NcsContext::NcsPkt> CoCpnMockNcsImpl::handlePacket(const simtime_t&
 
         pktUtilityHistory.push(utility);
     }
+}
+
+void CoCpnMockNcsImpl::writeSnapshot(SnapshotWriter& snapshot) {
+    snapshot.value("step", step, pktCounter);
+    snapshot.value("qoc", predictedQoC, actualQoC, activeTargetQoC, nextTargetQoC, targetQoCChanged);
+    snapshot.value("rate", rateAccumulator, ratePhaseShift, phaseShiftTracker, lastPhaseShiftRate);
+    snapshot.value("predictedPktUtility", predictedPktUtility);
+
+    snapshot.values("qocValues", qocValues);
+    rateValues.writeSnapshot(snapshot);
+    pktCount.writeSnapshot(snapshot);
+    pktUtilityHistory.writeSnapshot(snapshot);
+    caHist.writeSnapshot(snapshot);
+
+    qocRandomizer.writeSnapshot(snapshot);
+    rateRandomizer.writeSnapshot(snapshot);
+}
 
-    return std::vector<NcsContext::NcsPkt>();
+void CoCpnMockNcsImpl::readSnapshot(SnapshotReader& snapshot) {
+    snapshot.value("step", step, pktCounter);
+    snapshot.value("qoc", predictedQoC, actualQoC, activeTargetQoC, nextTargetQoC, targetQoCChanged);
+    snapshot.value("rate", rateAccumulator, ratePhaseShift, phaseShiftTracker, lastPhaseShiftRate);
+    snapshot.value("predictedPktUtility", predictedPktUtility);
+    rateFunctionChanged();
+
+    snapshot.values("qocValues", qocValues);
+    rateValues.readSnapshot(snapshot);
+    pktCount.readSnapshot(snapshot);
+    pktUtilityHistory.readSnapshot(snapshot);
+    caHist.readSnapshot(snapshot);
+
+    qocRandomizer.readSnapshot(snapshot);
+    rateRandomizer.readSnapshot(snapshot);
 }
 
 void CoCpnMockNcsImpl::updateLongTermUtilityPrediction() {
     // account for pkts which have been lost
-    HistogramCollector tmpHist = caHist;
+    const uint windowSamples = caHist.computeWindow(recentCaHist, simTime(),
+            tickerInterval * (maxPktDelay + 1), 0, maxPktDelay + 1,
+            tickerInterval, maxPktDelay + 3, true);
 
-    tmpHist.prune(simTime(), tickerInterval * (maxPktDelay + 1), 0, maxPktDelay + 1);
-    auto tmpHistValues = tmpHist.compute(simTime(), tickerInterval, maxPktDelay + 3, true);
-
-    if (tmpHist.sampleCount() > 0 && *(tmpHistValues.end() - 2) > 1E-10) {
+    if (windowSamples > 0 && *(recentCaHist.end() - 2) > 1E-10) {
         pktUtilityHistory.push(0);
     }
 
@@ -372,8 +411,14 @@ void CoCpnMockNcsImpl::updateLongTermUtilityPrediction() {
             EV_DEBUG << "resetting long term pkt utility statistics" << endl;
         }
 
+        const double lastPredictedPktUtility = predictedPktUtility;
+
         predictedPktUtility = pktUtilityHistory.stats[1].mean();
 
+        if (useRatePrediction && predictedPktUtility != lastPredictedPktUtility) {
+            rateFunctionChanged(); // scaling of the rate function changed
+        }
+
         EV_DEBUG << "shortTermMean=" << shortTermMean << " longTermMean=" << longTermMean << " longTermVariance=" << longTermVariance << " sqDelta=" << delta*delta << endl;
 
         emit(s_shortPredictedPktUtility, shortTermMean);
@@ -506,16 +551,43 @@ double CoCpnMockNcsImpl::ScaledMockFunction::eval(const double targetQoC) const
     return rate;
 }
 
-double CoCpnMockNcsImpl::ScaledMockFunction::predictionScaling(const double factor, const double x) const {
+bool CoCpnMockNcsImpl::ScaledMockFunction::evalWithDerivativeImpl(const double targetQoC, double &rate, double &slope) const {
+    ASSERT(parent->function);
+
+    const double scale = parent->getPredictionScalingFactor();
+
+    const double clampedActual = CLAMP(parent->actualQoC, 0.0, 1.0);
+    const double clampedTarget = CLAMP(targetQoC, 0.0, 1.0);
+
+    if (!parent->function->getPktRateAndSlopeForQoc(clampedActual, clampedTarget, rate, slope)) {
+        return false;
+    }
+
+    if (clampedTarget != targetQoC) {
+        slope = 0;
+    }
+
+    if (scale > UPSCALE_THRESH) {
+        const FunctionTools::Dual scaled = predictionScaling(scale, FunctionTools::Dual(rate, slope));
+
+        rate = scaled.value;
+        slope = scaled.slope;
+    }
+
+    return true;
+}
+
+template<typename T>
+T CoCpnMockNcsImpl::ScaledMockFunction::predictionScaling(const double factor, const T x) const {
     const double yInterpStart = 0.95;
     const double yControlPoint = 0.99; // avoid f'(1)==0
     const double xInterpStart = yInterpStart / factor;
     const double xControlPoint = 1 / factor;
 
-    if (x < 0) {
+    if (FunctionTools::valueOf(x) < 0) {
         return 0;
     }
-    if (x > 1) {
+    if (FunctionTools::valueOf(x) > 1) {
         // try to do something reasonable for x > 1
         // continue with linear interpolation starting at x=1
         const double m = (1 - yControlPoint) / (1 - xControlPoint);
@@ -523,13 +595,13 @@ double CoCpnMockNcsImpl::ScaledMockFunction::predictionScaling(const double fact
         return 1 + m * (x - 1);
     }
 
-    if (x <= xInterpStart) {
+    if (FunctionTools::valueOf(x) <= xInterpStart) {
         return factor * x;
     } else {
         // quadratic bezier interpolation for (0,0)->(a,b)->(1,1)
 
         // map input value from range [xInterpStart..1] into [0..1]
-        const double xb = (x - xInterpStart) / (1 - xInterpStart);
+        const T xb = (x - xInterpStart) / (1 - xInterpStart);
         // map linear intersection with y=1 from [xInterpStart..1] into [0..1]
         // used as x-value for second interpolation point
         // maintains slope at yInterpStart, thus transition will be smooth
@@ -549,8 +621,8 @@ double CoCpnMockNcsImpl::ScaledMockFunction::predictionScaling(const double fact
         }
         // solve t from x (an inverse operation)
         const double om2a = 1 - 2 * a;
-        const double t = (sqrt(a * a + om2a * xb) - a) / om2a;
-        const double y = (1 - 2 * b) * (t * t) + (2 * b) * t;
+        const T t = (sqrt(a * a + om2a * xb) - a) / om2a;
+        const T y = (1 - 2 * b) * (t * t) + (2 * b) * t;
 
         // map y-range [0..1] into [yInterpStart..1]
         return y * (1 - yInterpStart) + yInterpStart;
@@ -567,3 +639,19 @@ double CoCpnMockNcsImpl::PublicScaledMockFunction::eval(const double targetQoC)
     // scale up to pkt/s
     return clamped / interval;
 }
+
+bool CoCpnMockNcsImpl::PublicScaledMockFunction::evalWithDerivativeImpl(const double targetQoC, double &rate, double &slope) const {
+    if (!f.evalWithDerivative(targetQoC, rate, slope)) {
+        return false;
+    }
+
+    if (rate < 0.0 || rate > 1.0) {
+        slope = 0; // clamped
+    }
+
+    // scale up to pkt/s
+    rate = CLAMP(rate, 0.0, 1.0) / interval;
+    slope = slope / interval;
+
+    return true;
+}
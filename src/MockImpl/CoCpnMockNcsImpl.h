@@ -47,8 +47,14 @@ class CoCpnMockNcsImpl : public AbstractCoCpnNcsImpl, public cSimpleModule {
     virtual const simtime_t& getControlPeriod() override;
 
     virtual void doPlantStep(const simtime_t& ncstTime, NcsContext::NcsPlantStepResult * const result) override;
+    virtual void doPlantSteps(const simtime_t& from, const unsigned long count, NcsContext::NcsPlantStepResult * const result) override;
+    virtual simtime_t getNextPlantWakeup(const simtime_t& nextPlantStep) override;
     virtual void doControlStep(const simtime_t& ncsTime, NcsContext::NcsControlStepResult * const result) override;
-    virtual std::vector<NcsContext::NcsPkt> handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt) override;
+    virtual void handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) override;
+
+    virtual bool supportsSnapshots() override { return true; };
+    virtual void writeSnapshot(SnapshotWriter& snapshot) override;
+    virtual void readSnapshot(SnapshotReader& snapshot) override;
 
   private:
 
@@ -65,6 +71,8 @@ class CoCpnMockNcsImpl : public AbstractCoCpnNcsImpl, public cSimpleModule {
 
         // regular pktRate value range is [0,1] for all methods
         virtual double getPktRateForQoc(const double actualQoC, const double targetQoC) const = 0; // raw unscaled model function
+        // raw model function and its derivative with respect to targetQoC, false if the model provides no derivative
+        virtual bool getPktRateAndSlopeForQoc(const double, const double, double &, double &) const { return false; }
     };
 
   protected:
@@ -79,7 +87,8 @@ class CoCpnMockNcsImpl : public AbstractCoCpnNcsImpl, public cSimpleModule {
 
     protected:
         virtual double eval(const double targetQoC) const override;
-        double predictionScaling(const double factor, const double x) const;
+        virtual bool evalWithDerivativeImpl(const double targetQoC, double &rate, double &slope) const override;
+        template<typename T> T predictionScaling(const double factor, const T x) const;
 
         CoCpnMockNcsImpl * const parent;
     };
@@ -91,6 +100,7 @@ class CoCpnMockNcsImpl : public AbstractCoCpnNcsImpl, public cSimpleModule {
 
     protected:
         virtual double eval(const double targetQoC) const override;
+        virtual bool evalWithDerivativeImpl(const double targetQoC, double &rate, double &slope) const override;
 
         ScaledMockFunction &f;
         simtime_t &interval;
@@ -154,6 +164,8 @@ class CoCpnMockNcsImpl : public AbstractCoCpnNcsImpl, public cSimpleModule {
     RunningWindowStats<int,int> pktCount;
     ChainedRunningWindowStats<double> pktUtilityHistory { ChainedRunningWindowStats<double>(2) };
     HistogramCollector caHist;
+    // scratch buffer for the distribution of the most recent caHist samples
+    std::vector<double> recentCaHist;
 
     double predictedPktUtility;
 
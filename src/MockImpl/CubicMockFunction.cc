@@ -35,19 +35,33 @@ void CubicMockFunction::handleMessage(cMessage * const msg) {
 }
 
 double CubicMockFunction::getPktRateForQoc(const double actualQoC, const double targetQoC) const {
+    return evalRate(actualQoC, targetQoC);
+}
+
+bool CubicMockFunction::getPktRateAndSlopeForQoc(const double actualQoC, const double targetQoC, double &rate, double &slope) const {
+    const FunctionTools::Dual z = evalRate(actualQoC, FunctionTools::Dual(targetQoC, 1));
+
+    rate = z.value;
+    slope = z.slope;
+
+    return true;
+}
+
+template<typename T>
+T CubicMockFunction::evalRate(const double actualQoC, const T targetQoC) const {
     const double x = actualQoC;
-    const double y = targetQoC;
+    const T y = targetQoC;
 
-    const double xPy = x + y;
-    const double yMx = y - x;
+    const T xPy = x + y;
+    const T yMx = y - x;
 
-    const double sigmoidFactor = s * t * yMx / (1 + t * yMx*yMx);
-    const double sigmoidDamping = 1 - (xPy*xPy) / u;
-    const double sigmoidTotal = sigmoidDamping * sigmoidFactor + 1;
+    const T sigmoidFactor = s * t * yMx / (1 + t * yMx*yMx);
+    const T sigmoidDamping = 1 - (xPy*xPy) / u;
+    const T sigmoidTotal = sigmoidDamping * sigmoidFactor + 1;
 
-    const double cubic = a * xPy*xPy*xPy + b * xPy*xPy + c * xPy + d;
+    const T cubic = a * xPy*xPy*xPy + b * xPy*xPy + c * xPy + d;
 
-    const double z = sigmoidTotal * cubic;
+    const T z = sigmoidTotal * cubic;
 
     return z; // unbounded!
 }
@@ -30,9 +30,12 @@ class CubicMockFunction : public CoCpnMockNcsImpl::MockFunction, public cSimpleM
     virtual void handleMessage(cMessage * const msg) override;
 
     virtual double getPktRateForQoc(const double actualQoC, const double targetQoC) const override;
+    virtual bool getPktRateAndSlopeForQoc(const double actualQoC, const double targetQoC, double &rate, double &slope) const override;
 
   private:
 
+    template<typename T> T evalRate(const double actualQoC, const T targetQoC) const;
+
     // polynomial parameters
     double a, b, c, d;
     // sigmoid parameters
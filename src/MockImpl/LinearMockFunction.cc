@@ -30,8 +30,22 @@ void LinearMockFunction::handleMessage(cMessage * const msg) {
 }
 
 double LinearMockFunction::getPktRateForQoc(const double actualQoC, const double targetQoC) const {
+    return std::max(0.0, evalRate(actualQoC, targetQoC));
+}
+
+bool LinearMockFunction::getPktRateAndSlopeForQoc(const double actualQoC, const double targetQoC, double &rate, double &rateSlope) const {
+    const FunctionTools::Dual z = evalRate(actualQoC, FunctionTools::Dual(targetQoC, 1));
+
+    rate = std::max(0.0, z.value);
+    rateSlope = z.value > 0 ? z.slope : 0;
+
+    return true;
+}
+
+template<typename T>
+T LinearMockFunction::evalRate(const double actualQoC, const T targetQoC) const {
     const double x = actualQoC;
-    const double y = targetQoC;
+    const T y = targetQoC;
 
     const double m = slope;
     const double n = twist;
@@ -41,7 +55,7 @@ double LinearMockFunction::getPktRateForQoc(const double actualQoC, const double
     const double fb = m*n*x - m;
     const double fc = b;
 
-    const double z = fa*y*y - fb*y + fc;
+    const T z = fa*y*y - fb*y + fc;
 
-    return std::max(0.0, z);
+    return z; // unbounded!
 }
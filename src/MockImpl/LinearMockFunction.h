@@ -30,9 +30,12 @@ class LinearMockFunction : public CoCpnMockNcsImpl::MockFunction, public cSimple
     virtual void handleMessage(cMessage * const msg) override;
 
     virtual double getPktRateForQoc(const double actualQoC, const double targetQoC) const override;
+    virtual bool getPktRateAndSlopeForQoc(const double actualQoC, const double targetQoC, double &rate, double &rateSlope) const override;
 
   private:
 
+    template<typename T> T evalRate(const double actualQoC, const T targetQoC) const;
+
     double slope;
     double twist;
     double offset;
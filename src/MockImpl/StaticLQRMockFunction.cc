@@ -15,6 +15,8 @@
 
 #include "StaticLQRMockFunction.h"
 
+#include <cstring>
+
 Define_Module(StaticLQRMockFunction);
 
 
@@ -35,6 +37,8 @@ void StaticLQRMockFunction::initialize() {
     qoc = &par("qoc");
     rateFunction = &par("rateFunction");
 
+    compileRateFunction();
+
     if (normalize) {
         normalize = false; // lazy hack to re-use code in getPktRate
 
@@ -48,13 +52,32 @@ void StaticLQRMockFunction::handleMessage(cMessage * const msg) {
     error("StaticLQRMockFunction received unexpected message");
 }
 
+void StaticLQRMockFunction::handleParameterChange(const char * parname) {
+    // qoc is changed for each NED expression evaluation, only rateFunction affects the compiled form
+    if (!parname || strcmp(parname, "rateFunction") == 0) {
+        compileRateFunction();
+    }
+}
+
+void StaticLQRMockFunction::compileRateFunction() {
+    if (model == Function && par("compileRateFunction").boolValue()) {
+        if (!compiledRateFunction.compile(rateFunction->str(), qoc->getName())) {
+            EV_WARN << "unable to compile rateFunction " << rateFunction->str() << ", falling back to NED expression evaluation" << endl;
+        }
+    }
+}
+
 double StaticLQRMockFunction::getPktRateForQoc(const double actualQoC, const double targetQoC) const {
     double result;
 
     switch (model) {
     case Function:
-        qoc->setDoubleValue(targetQoC);
-        result = rateFunction->doubleValue();
+        if (compiledRateFunction.isCompiled()) {
+            result = compiledRateFunction.eval(targetQoC);
+        } else {
+            qoc->setDoubleValue(targetQoC);
+            result = rateFunction->doubleValue();
+        }
         break;
     case LQRFit1:
         result = (a * targetQoC + b) / (targetQoC + c);
@@ -69,3 +92,23 @@ double StaticLQRMockFunction::getPktRateForQoc(const double actualQoC, const dou
 
     return result;
 }
+
+bool StaticLQRMockFunction::getPktRateAndSlopeForQoc(const double, const double targetQoC, double &rate, double &slope) const {
+    switch (model) {
+    case Function:
+        return false; // arbitrary expression, no analytic derivative
+    case LQRFit1:
+        rate = (a * targetQoC + b) / (targetQoC + c);
+        slope = (a * c - b) / ((targetQoC + c) * (targetQoC + c));
+        break;
+    default:
+        error("model %d not implemented", model);
+    }
+
+    if (normalize) {
+        rate *= multiplier;
+        slope *= multiplier;
+    }
+
+    return true;
+}
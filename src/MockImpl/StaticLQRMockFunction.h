@@ -17,6 +17,7 @@
 #define __LIBNCS_OMNET_STATICLQRMOCKFUNCTION_H_
 
 #include "CoCpnMockNcsImpl.h"
+#include "MockImpl/util/CompiledExpression.h"
 
 #include <omnetpp.h>
 
@@ -28,8 +29,10 @@ class StaticLQRMockFunction : public CoCpnMockNcsImpl::MockFunction, public cSim
 
     virtual void initialize() override;
     virtual void handleMessage(cMessage * const msg) override;
+    virtual void handleParameterChange(const char * parname) override;
 
     virtual double getPktRateForQoc(const double actualQoC, const double targetQoC) const override;
+    virtual bool getPktRateAndSlopeForQoc(const double actualQoC, const double targetQoC, double &rate, double &slope) const override;
 
   protected:
 
@@ -41,6 +44,8 @@ class StaticLQRMockFunction : public CoCpnMockNcsImpl::MockFunction, public cSim
 
   private:
 
+    void compileRateFunction();
+
     bool normalize;
 
     Model model;
@@ -49,6 +54,7 @@ class StaticLQRMockFunction : public CoCpnMockNcsImpl::MockFunction, public cSim
 
     cPar * qoc;
     cPar * rateFunction;
+    CompiledExpression compiledRateFunction;
 
     double multiplier;
 
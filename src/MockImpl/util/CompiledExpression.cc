@@ -0,0 +1,347 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "CompiledExpression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+
+namespace {
+
+struct NamedFunction1 {
+    const char * name;
+    double (*f)(double);
+};
+
+struct NamedFunction2 {
+    const char * name;
+    double (*f)(double, double);
+};
+
+const NamedFunction1 functions1[] = {
+    { "sin", [](double x) { return std::sin(x); } },
+    { "cos", [](double x) { return std::cos(x); } },
+    { "tan", [](double x) { return std::tan(x); } },
+    { "asin", [](double x) { return std::asin(x); } },
+    { "acos", [](double x) { return std::acos(x); } },
+    { "atan", [](double x) { return std::atan(x); } },
+    { "exp", [](double x) { return std::exp(x); } },
+    { "log", [](double x) { return std::log(x); } },
+    { "log10", [](double x) { return std::log10(x); } },
+    { "sqrt", [](double x) { return std::sqrt(x); } },
+    { "fabs", [](double x) { return std::fabs(x); } },
+    { "floor", [](double x) { return std::floor(x); } },
+    { "ceil", [](double x) { return std::ceil(x); } },
+};
+
+const NamedFunction2 functions2[] = {
+    { "atan2", [](double y, double x) { return std::atan2(y, x); } },
+    { "pow", [](double x, double y) { return std::pow(x, y); } },
+    { "fmod", [](double x, double y) { return std::fmod(x, y); } },
+    { "hypot", [](double x, double y) { return std::hypot(x, y); } },
+    { "min", [](double x, double y) { return std::min(x, y); } },
+    { "max", [](double x, double y) { return std::max(x, y); } },
+};
+
+}
+
+
+bool CompiledExpression::compile(const std::string& text, const std::string& variable) {
+    code.clear();
+
+    cursor = text.c_str();
+    var = variable;
+    depth = 0;
+    maxDepth = 0;
+
+    bool ok = parseSum();
+
+    skipSpace();
+
+    // trailing input (units, unsupported operators) cannot be handled
+    ok = ok && *cursor == '\0' && depth == 1 && maxDepth <= MAX_STACK;
+
+    if (!ok) {
+        code.clear();
+    }
+
+    cursor = nullptr;
+
+    return ok;
+}
+
+double CompiledExpression::eval(const double x) const {
+    double stack[MAX_STACK];
+    size_t top = 0;
+
+    for (const auto& instr : code) {
+        switch (instr.op) {
+        case PUSH_CONST:
+            stack[top++] = instr.value;
+            break;
+        case PUSH_VAR:
+            stack[top++] = x;
+            break;
+        case NEG:
+            stack[top - 1] = -stack[top - 1];
+            break;
+        case CALL1:
+            stack[top - 1] = instr.f1(stack[top - 1]);
+            break;
+        default:
+            top--;
+            stack[top - 1] = apply(instr, stack[top - 1], stack[top]);
+            break;
+        }
+    }
+
+    return stack[0];
+}
+
+double CompiledExpression::apply(const Instruction& instr, const double a, const double b) {
+    switch (instr.op) {
+    case ADD:
+        return a + b;
+    case SUB:
+        return a - b;
+    case MUL:
+        return a * b;
+    case DIV:
+        return a / b;
+    case POW:
+        return std::pow(a, b);
+    case CALL2:
+        return instr.f2(a, b);
+    default:
+        return NAN; // not a binary operation
+    }
+}
+
+bool CompiledExpression::parseSum() {
+    if (!parseProduct()) {
+        return false;
+    }
+
+    while (true) {
+        if (accept('+')) {
+            if (!parseProduct()) {
+                return false;
+            }
+            emitBinary(ADD);
+        } else if (accept('-')) {
+            if (!parseProduct()) {
+                return false;
+            }
+            emitBinary(SUB);
+        } else {
+            return true;
+        }
+    }
+}
+
+bool CompiledExpression::parseProduct() {
+    if (!parsePower()) {
+        return false;
+    }
+
+    while (true) {
+        if (accept('*')) {
+            if (!parsePower()) {
+                return false;
+            }
+            emitBinary(MUL);
+        } else if (accept('/')) {
+            if (!parsePower()) {
+                return false;
+            }
+            emitBinary(DIV);
+        } else {
+            return true;
+        }
+    }
+}
+
+bool CompiledExpression::parsePower() {
+    if (!parseUnary()) {
+        return false;
+    }
+
+    // right associative
+    if (accept('^')) {
+        if (!parsePower()) {
+            return false;
+        }
+        emitBinary(POW);
+    }
+
+    return true;
+}
+
+bool CompiledExpression::parseUnary() {
+    // unary minus binds stronger than ^ in NED expressions
+    if (accept('-')) {
+        if (!parseUnary()) {
+            return false;
+        }
+
+        if (code.back().op == PUSH_CONST) {
+            code.back().value = -code.back().value;
+        } else {
+            emit({ NEG, 0, nullptr, nullptr });
+        }
+
+        return true;
+    }
+
+    if (accept('+')) {
+        return parseUnary();
+    }
+
+    return parsePrimary();
+}
+
+bool CompiledExpression::parsePrimary() {
+    skipSpace();
+
+    if (accept('(')) {
+        return parseSum() && accept(')');
+    }
+
+    if (std::isdigit(static_cast<unsigned char>(*cursor)) || *cursor == '.') {
+        char * end;
+        const double value = std::strtod(cursor, &end);
+
+        if (end == cursor) {
+            return false;
+        }
+
+        cursor = end;
+        emit({ PUSH_CONST, value, nullptr, nullptr });
+
+        return true;
+    }
+
+    if (std::isalpha(static_cast<unsigned char>(*cursor)) || *cursor == '_') {
+        const char * start = cursor;
+
+        while (std::isalnum(static_cast<unsigned char>(*cursor)) || *cursor == '_') {
+            cursor++;
+        }
+
+        const std::string name(start, cursor);
+
+        if (accept('(')) {
+            return parseCall(name);
+        }
+
+        if (name != var) {
+            return false; // other parameters or NED constants
+        }
+
+        emit({ PUSH_VAR, 0, nullptr, nullptr });
+
+        return true;
+    }
+
+    return false;
+}
+
+bool CompiledExpression::parseCall(const std::string& name) {
+    for (const auto& f : functions1) {
+        if (name == f.name) {
+            if (!parseSum() || !accept(')')) {
+                return false;
+            }
+
+            if (code.back().op == PUSH_CONST) {
+                code.back().value = f.f(code.back().value);
+            } else {
+                emit({ CALL1, 0, f.f, nullptr });
+            }
+
+            return true;
+        }
+    }
+
+    for (const auto& f : functions2) {
+        if (name == f.name) {
+            if (!parseSum() || !accept(',') || !parseSum() || !accept(')')) {
+                return false;
+            }
+
+            emitBinary(CALL2, f.f);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CompiledExpression::skipSpace() {
+    while (std::isspace(static_cast<unsigned char>(*cursor))) {
+        cursor++;
+    }
+}
+
+bool CompiledExpression::accept(const char c) {
+    skipSpace();
+
+    if (*cursor == c) {
+        cursor++;
+
+        return true;
+    }
+
+    return false;
+}
+
+void CompiledExpression::emit(const Instruction& instr) {
+    switch (instr.op) {
+    case PUSH_CONST:
+    case PUSH_VAR:
+        depth++;
+        maxDepth = std::max(maxDepth, depth);
+        break;
+    case NEG:
+    case CALL1:
+        break;
+    default:
+        depth--;
+        break;
+    }
+
+    code.push_back(instr);
+}
+
+void CompiledExpression::emitBinary(const OpCode op, const Function2 f) {
+    const Instruction instr = { op, 0, nullptr, f };
+    const size_t n = code.size();
+
+    // fold constant operands
+    if (n >= 2 && code[n - 2].op == PUSH_CONST && code[n - 1].op == PUSH_CONST) {
+        code[n - 2].value = apply(instr, code[n - 2].value, code[n - 1].value);
+        code.pop_back();
+        depth--;
+
+        return;
+    }
+
+    emit(instr);
+}
@@ -0,0 +1,95 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef MOCKIMPL_UTIL_COMPILEDEXPRESSION_H_
+#define MOCKIMPL_UTIL_COMPILEDEXPRESSION_H_
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Arithmetic expression in a single variable, compiled once into a flat
+ * stack program and evaluated without any parsing or lookups.
+ *
+ * Understands the subset of the NED expression syntax used for mock rate
+ * functions: numeric literals, the variable, + - * / ^, unary minus,
+ * parentheses and the common math functions (sin, cos, tan, asin, acos, atan,
+ * atan2, exp, log, log10, sqrt, fabs, floor, ceil, pow, fmod, hypot, min, max).
+ * compile() reports anything else as unsupported, callers are expected to
+ * fall back to regular NED expression evaluation in that case.
+ */
+class CompiledExpression {
+  public:
+    CompiledExpression() { };
+
+    // false if text uses unsupported syntax, the expression is left empty then
+    bool compile(const std::string& text, const std::string& variable);
+    bool isCompiled() const { return !code.empty(); };
+
+    double eval(const double x) const;
+
+  private:
+
+    enum OpCode {
+        PUSH_CONST,
+        PUSH_VAR,
+        NEG,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        POW,
+        CALL1,
+        CALL2
+    };
+
+    typedef double (*Function1)(double);
+    typedef double (*Function2)(double, double);
+
+    struct Instruction {
+        OpCode op;
+        double value;
+        Function1 f1;
+        Function2 f2;
+    };
+
+    static const size_t MAX_STACK = 32;
+
+    // recursive descent following the NED operator precedence
+    bool parseSum();
+    bool parseProduct();
+    bool parsePower();
+    bool parseUnary();
+    bool parsePrimary();
+    bool parseCall(const std::string& name);
+
+    void skipSpace();
+    bool accept(const char c);
+    void emit(const Instruction& instr);
+    void emitBinary(const OpCode op, const Function2 f = nullptr);
+
+    static double apply(const Instruction& instr, const double a, const double b);
+
+    std::vector<Instruction> code;
+
+    // parser state, only valid during compile()
+    const char * cursor = nullptr;
+    std::string var;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+};
+
+#endif /* MOCKIMPL_UTIL_COMPILEDEXPRESSION_H_ */
@@ -52,6 +52,14 @@ double Interpolator::getNext() const {
     return next;
 }
 
+void Interpolator::writeSnapshot(SnapshotWriter& snapshot) const {
+    snapshot.value("interpolator", period, last, next);
+}
+
+void Interpolator::readSnapshot(SnapshotReader& snapshot) {
+    snapshot.value("interpolator", period, last, next);
+}
+
 Interpolator Interpolator::createInterpolator(const unsigned long period, const double last, const double next) {
     return Interpolator(period, last, next);
 }
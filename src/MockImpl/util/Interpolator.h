@@ -18,6 +18,8 @@
 
 #include <omnetpp.h>
 
+#include "util/Snapshot.h"
+
 using namespace omnetpp;
 
 
@@ -35,6 +37,9 @@ class Interpolator {
     double getLast() const;
     double getNext() const;
 
+    void writeSnapshot(SnapshotWriter& snapshot) const;
+    void readSnapshot(SnapshotReader& snapshot);
+
     static Interpolator createInterpolator(const unsigned long period, const double last, const double next);
 
   private:
@@ -36,6 +36,18 @@ void RandomInterpolator::update() {
     Interpolator::update(next);
 }
 
+void RandomInterpolator::writeSnapshot(SnapshotWriter& snapshot) const {
+    Interpolator::writeSnapshot(snapshot);
+
+    snapshot.value("randomInterpolator", mean, spread);
+}
+
+void RandomInterpolator::readSnapshot(SnapshotReader& snapshot) {
+    Interpolator::readSnapshot(snapshot);
+
+    snapshot.value("randomInterpolator", mean, spread);
+}
+
 RandomInterpolator RandomInterpolator::createRandomInterpolator(const unsigned long period, cRNG * const rng, const double mean, const double spread) {
     return RandomInterpolator(period, rng, mean, spread);
 }
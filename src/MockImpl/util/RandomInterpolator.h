@@ -33,6 +33,10 @@ class RandomInterpolator: public Interpolator {
 
     void update();
 
+    // the RNG itself is not part of the snapshot, it is kept as configured
+    void writeSnapshot(SnapshotWriter& snapshot) const;
+    void readSnapshot(SnapshotReader& snapshot);
+
     static RandomInterpolator createRandomInterpolator(const unsigned long period, cRNG * const rng, const double mean, const double spread);
 
   private:
@@ -9,8 +9,19 @@
 #define MOCKIMPL_UTIL_WINDOWSTATS_H_
 
 #include <assert.h>
-#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
+#include "util/Snapshot.h"
+
+/**
+ * Statistics over a sliding window of the most recently pushed values.
+ *
+ * Values are kept in a contiguous ring buffer with a capacity of maxSize(),
+ * thus pushing a value never allocates and reductions run over at most two
+ * contiguous segments.
+ */
 template<typename Tval, typename Tagg = double>
 class WindowStats {
 
@@ -35,32 +46,54 @@ public:
 
 
     virtual void reset() {
-        buf.clear();
+        first = 0;
+        count = 0;
     }
 
     virtual void reset(const Tval value) {
-        buf.assign(buf.size(), value);
+        std::fill(buf.begin(), buf.end(), value);
     }
 
     virtual void truncate(const unsigned long size) {
-        if (buf.size() > size) {
-            buf.resize(size);
+        if (count > size) {
+            // keep the most recent values
+            first = wrap(first + (count - size));
+            count = size;
         }
     }
 
     virtual void resize(const unsigned long size) {
         assert(size > 1);
 
-        this->sizeLimit = size;
-
         truncate(size);
+
+        // move the window to the start of a buffer of the new capacity
+        std::vector<Tval> values(size);
+
+        for (unsigned long i = 0; i < count; i++) {
+            values[i] = at(i);
+        }
+
+        this->sizeLimit = size;
+        buf.swap(values);
+        first = 0;
     }
 
     virtual void resize(const unsigned long size, const Tval value) {
         assert(size > 1);
 
+        // missing values are added as the oldest ones
+        const unsigned long kept = std::min(count, size);
+        std::vector<Tval> values(size, value);
+
+        for (unsigned long i = 0; i < kept; i++) {
+            values[size - kept + i] = at(count - kept + i);
+        }
+
         this->sizeLimit = size;
-        buf.resize(size, value);
+        buf.swap(values);
+        first = 0;
+        count = size;
     }
 
     unsigned long maxSize() const {
@@ -68,7 +101,7 @@ public:
     }
 
     unsigned long windowSize() const {
-        return buf.size();
+        return count;
     }
 
     virtual Sample push(const Tval value) {
@@ -76,58 +109,85 @@ public:
 
         Sample result;
 
-        if (buf.size() == sizeLimit) {
-            result.value = buf.back();
+        if (count == sizeLimit) {
+            // replace the oldest value
+            result.value = buf[first];
             result.valid = true;
 
-            buf.pop_back();
+            buf[first] = value;
+            first = wrap(first + 1);
         } else {
             result.valid = false;
-        }
 
-        buf.push_front(value);
+            buf[wrap(first + count)] = value;
+            count++;
+        }
 
         return result;
     }
 
+    virtual void writeSnapshot(SnapshotWriter& snapshot) const {
+        // most recent value first
+        std::vector<Tval> window;
 
-    virtual Tval sum() const {
-        Tval sum = 0;
+        window.reserve(count);
+
+        for (unsigned long i = count; i > 0; i--) {
+            window.push_back(at(i - 1));
+        }
+
+        snapshot.value("windowSizeLimit", sizeLimit);
+        snapshot.values("window", window);
+    }
+
+    virtual void readSnapshot(SnapshotReader& snapshot) {
+        std::vector<Tval> window;
 
-        for (auto val : buf) {
-            sum += val;
+        snapshot.value("windowSizeLimit", sizeLimit);
+        snapshot.values("window", window);
+
+        assert(window.size() <= sizeLimit);
+
+        buf.assign(sizeLimit, 0);
+        first = 0;
+        count = window.size();
+
+        for (unsigned long i = 0; i < count; i++) {
+            buf[i] = window[count - 1 - i];
         }
+    }
+
+
+    virtual Tval sum() const {
+        Tval result = 0;
+
+        forEachSegment([&result](const Tval * const data, const unsigned long length) {
+            result += sumKernel(data, length);
+        });
 
-        return sum;
+        return result;
     }
 
     virtual Tagg mean() const {
-        if (buf.size() == 0) {
+        if (count == 0) {
             return 0;
         }
 
         Tagg meanValue = sum();
-        meanValue /= buf.size();
+        meanValue /= count;
 
         return meanValue;
     }
 
     virtual Tagg variance(const Tagg epsilon = 1E-7) const {
-        if (buf.size() == 0) {
+        if (count == 0) {
             return 0;
         }
 
-        const Tagg m = mean();
-        Tagg sum = 0;
-
-        for (auto val : buf) {
-            const Tagg diff = val - m;
-
-            sum += diff * diff;
-        }
+        const Tagg sum = squaredDeviations<Tagg>(mean());
 
         if (sum > epsilon) {
-            return sum / (buf.size() - 1);
+            return sum / (count - 1);
         } else {
             return -1;
         }
@@ -135,13 +195,98 @@ public:
 
 protected:
 
+    // i-th oldest value within the window
+    const Tval& at(const unsigned long i) const {
+        return buf[wrap(first + i)];
+    }
+
+    unsigned long wrap(const unsigned long index) const {
+        return (index >= sizeLimit) ? index - sizeLimit : index;
+    }
+
+    // calls f(data, length) for both contiguous parts of the window
+    template<typename F>
+    void forEachSegment(F f) const {
+        const unsigned long head = std::min(count, sizeLimit - first);
+
+        f(buf.data() + first, head);
+
+        if (head < count) {
+            f(buf.data(), count - head);
+        }
+    }
+
+    template<typename T>
+    T squaredDeviations(const T m) const {
+        T result = 0;
+
+        forEachSegment([&result, m](const Tval * const data, const unsigned long length) {
+            result += squaredDeviationsKernel<T>(data, length, m);
+        });
+
+        return result;
+    }
+
+    // independent partial sums allow the compiler to vectorize the loops.
+    // this reorders the additions, for floating point values the result may
+    // thus differ in the last bits from a sequential sum
+    static Tval sumKernel(const Tval * const data, const unsigned long length) {
+        Tval partial[4] = { 0, 0, 0, 0 };
+        unsigned long i = 0;
+
+        for (; i + 4 <= length; i += 4) {
+            partial[0] += data[i];
+            partial[1] += data[i + 1];
+            partial[2] += data[i + 2];
+            partial[3] += data[i + 3];
+        }
+
+        for (; i < length; i++) {
+            partial[0] += data[i];
+        }
+
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+
+    template<typename T>
+    static T squaredDeviationsKernel(const Tval * const data, const unsigned long length, const T m) {
+        T partial[4] = { 0, 0, 0, 0 };
+        unsigned long i = 0;
+
+        for (; i + 4 <= length; i += 4) {
+            for (unsigned int j = 0; j < 4; j++) {
+                const T diff = data[i + j] - m;
+
+                partial[j] += diff * diff;
+            }
+        }
+
+        for (; i < length; i++) {
+            const T diff = data[i] - m;
+
+            partial[0] += diff * diff;
+        }
+
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+
     unsigned long sizeLimit = 2;
-    std::deque<Tval> buf = { };
+    // ring buffer of sizeLimit entries, the window starts at first
+    std::vector<Tval> buf = std::vector<Tval>(2);
+    unsigned long first = 0;
+    unsigned long count = 0;
 
 };
 
+/**
+ * WindowStats with sum and variance maintained on each push.
+ *
+ * The variance is tracked with Welford's method adapted to sliding windows,
+ * which avoids the cancellation of the sum-of-squares approach. Running mean
+ * and M2 are always kept in double, Tagg may be an integral type.
+ */
 template<typename Tval, typename Tagg = double>
-class RunningWindowStats : public WindowStats<Tval, Tagg> {
+class RunningWindowStats final : public WindowStats<Tval, Tagg> {
 
 public:
 
@@ -160,7 +305,14 @@ public:
         pushCount = 0;
 
         simpleSum = WindowStats<Tval, Tagg>::sum();
-        squaredSum = sumSquared();
+
+        if (this->count > 0) {
+            runningMean = static_cast<double>(simpleSum) / this->count;
+        } else {
+            runningMean = 0;
+        }
+
+        runningM2 = this->template squaredDeviations<double>(runningMean);
     }
 
     virtual void reset() override {
@@ -169,7 +321,8 @@ public:
         pushCount = 0;
 
         simpleSum = 0;
-        squaredSum = 0;
+        runningMean = 0;
+        runningM2 = 0;
     }
 
     virtual void reset(const Tval value) override {
@@ -177,16 +330,17 @@ public:
 
         pushCount = 0;
 
-        simpleSum = this->buf.size() * value;
-        squaredSum = this->buf.size() * value * value;
+        simpleSum = this->count * value;
+        runningMean = value;
+        runningM2 = 0;
     }
 
     virtual void truncate(const unsigned long size) override {
-        const unsigned long oldSize = this->buf.size();
+        const unsigned long oldSize = this->count;
 
         WindowStats<Tval, Tagg>::truncate(size);
 
-        if (oldSize != this->buf.size()) {
+        if (oldSize != this->count) {
             recomputeStats();
         }
     }
@@ -201,16 +355,30 @@ public:
         recomputeStats();
     }
 
-    virtual typename WindowStats<Tval, Tagg>::Sample push(const Tval value) {
+    virtual typename WindowStats<Tval, Tagg>::Sample push(const Tval value) override {
         const auto old = WindowStats<Tval, Tagg>::push(value);
+        const double oldMean = runningMean;
 
         if (old.valid) {
+            // window is full, the oldest value is replaced
+            const double delta = static_cast<double>(value) - old.value;
+
             simpleSum -= old.value;
-            squaredSum -= old.value*old.value;
+
+            runningMean += delta / this->count;
+            runningM2 += delta * ((value - runningMean) + (old.value - oldMean));
+        } else {
+            const double delta = value - oldMean;
+
+            runningMean += delta / this->count;
+            runningM2 += delta * (value - runningMean);
         }
 
         simpleSum += value;
-        squaredSum += value*value;
+
+        if (runningM2 < 0) {
+            runningM2 = 0; // rounding, the window holds (almost) equal values
+        }
 
         // trigger recomputation to prevent increasing errors
         if (pushCount++ > 10000) {
@@ -220,36 +388,49 @@ public:
         return old;
     }
 
+    virtual void writeSnapshot(SnapshotWriter& snapshot) const override {
+        WindowStats<Tval, Tagg>::writeSnapshot(snapshot);
+
+        // running stats are stored as well, recomputing them would change rounding
+        snapshot.value("windowRunningStats", pushCount, simpleSum, runningMean, runningM2);
+    }
+
+    virtual void readSnapshot(SnapshotReader& snapshot) override {
+        WindowStats<Tval, Tagg>::readSnapshot(snapshot);
+
+        snapshot.value("windowRunningStats", pushCount, simpleSum, runningMean, runningM2);
+    }
+
     Tval sumSquared() const {
         Tval result = 0;
 
-        for (auto val : this->buf) {
-            result += val*val;
-        }
+        this->forEachSegment([&result](const Tval * const data, const unsigned long length) {
+            for (unsigned long i = 0; i < length; i++) {
+                result += data[i] * data[i];
+            }
+        });
 
         return result;
     }
 
-    virtual Tval sum() const {
+    virtual Tval sum() const override {
         return simpleSum;
     }
 
-    virtual Tagg mean() const {
+    virtual Tagg mean() const override {
         Tagg meanValue = simpleSum;
-        meanValue /= this->buf.size();
+        meanValue /= this->count;
 
         return meanValue;
     }
 
-    virtual Tagg variance(const Tagg epsilon = 1E-7) const {
-        if (this->buf.size() == 0) {
+    virtual Tagg variance(const Tagg epsilon = 1E-7) const override {
+        if (this->count == 0) {
             return 0;
         }
 
-        Tagg result = squaredSum - (simpleSum * simpleSum) / this->buf.size();
-
-        if (result > epsilon) {
-            return result / (this->buf.size() - 1);
+        if (runningM2 > epsilon) {
+            return runningM2 / (this->count - 1);
         } else {
             return -1;
         }
@@ -259,102 +440,445 @@ protected:
 
     unsigned long pushCount = 0;
     Tval simpleSum = 0;
-    Tval squaredSum = 0;
+    // mean and sum of squared deviations from the mean (Welford)
+    double runningMean = 0;
+    double runningM2 = 0;
 
 };
 
+/**
+ * Multiple windows over one shared history of pushed values.
+ *
+ * The history is kept as prefix sums of the values and of their squares in a
+ * single ring buffer, thus sum, mean and variance of each window are O(1)
+ * queries and truncating the history does not require any recomputation.
+ * The prefix sums are taken over the values shifted by a reference value.
+ * Once per pass through the ring buffer, they are recomputed from the
+ * retained values around their mean. This bounds rounding errors and avoids
+ * the cancellation of the sum-of-squares variance for (almost) constant values.
+ *
+ * Chained windows are consecutive, i.e. values leaving the first window enter
+ * the second one and so on. Overlapping windows all end at the most recent value.
+ */
 template<typename Tval, typename Tagg = double>
-class ChainedRunningWindowStats {
+class SharedRunningWindowStats {
 
 public:
 
-    ChainedRunningWindowStats(uint numStats) {
+    /**
+     * Window within the shared history, provides the query interface of
+     * RunningWindowStats.
+     */
+    class Window {
+
+    public:
+
+        unsigned long maxSize() const {
+            return sizeLimit;
+        }
+
+        unsigned long windowSize() const {
+            return count;
+        }
+
+        void resize(const unsigned long size) {
+            owner->resizeWindow(index, size);
+        }
+
+        Tval sum() const {
+            return shiftedSum() + count * owner->reference;
+        }
+
+        Tval sumSquared() const {
+            const Tval r = owner->reference;
+
+            return shiftedSumSquared() + 2 * r * shiftedSum() + count * r * r;
+        }
+
+        Tagg mean() const {
+            Tagg meanValue = sum();
+            meanValue /= count;
+
+            return meanValue;
+        }
+
+        Tagg variance(const Tagg epsilon = 1E-7) const {
+            if (count == 0) {
+                return 0;
+            }
+
+            if (count < 2) {
+                return -1;
+            }
+
+            // the variance does not depend on the shift, thus the shifted sums are used directly
+            const Tval simpleSum = shiftedSum();
+            const Tagg simpleSumSquared = shiftedSumSquared();
+            Tagg result = simpleSumSquared - (simpleSum * simpleSum) / count;
+
+            // prefix sum rounding scales with the magnitude of the squares, thus epsilon is relative to it
+            if (result > epsilon * std::max(Tagg(1), simpleSumSquared)) {
+                return result / (count - 1);
+            } else {
+                return -1;
+            }
+        }
+
+    protected:
+
+        friend class SharedRunningWindowStats;
+
+        Tval shiftedSum() const {
+            return owner->rangeSum(owner->prefixSum, owner->windowStart(index), count);
+        }
+
+        Tval shiftedSumSquared() const {
+            return owner->rangeSum(owner->prefixSquaredSum, owner->windowStart(index), count);
+        }
+
+        SharedRunningWindowStats * owner = nullptr;
+        unsigned int index = 0;
+        unsigned long sizeLimit = 2;
+        unsigned long count = 0;
+
+    };
+
+    SharedRunningWindowStats(const uint numStats, const bool chained) : chained(chained) {
         stats.resize(numStats);
+        bindWindows();
 
         reset();
     }
 
+    SharedRunningWindowStats(const SharedRunningWindowStats& other) {
+        *this = other;
+    }
+
+    SharedRunningWindowStats& operator=(const SharedRunningWindowStats& other) {
+        chained = other.chained;
+        stats = other.stats;
+        prefixSum = other.prefixSum;
+        prefixSquaredSum = other.prefixSquaredSum;
+        values = other.values;
+        reference = other.reference;
+        pushes = other.pushes;
+        stored = other.stored;
+
+        bindWindows();
+
+        return *this;
+    }
+
     void reset() {
-        for (auto stat : stats) {
-            stat.reset();
+        for (auto& window : stats) {
+            window.count = 0;
         }
+
+        pushes = 0;
+        stored = 0;
+        reference = 0;
+
+        prefixSum.assign(historyLimit() + 1, 0);
+        prefixSquaredSum.assign(historyLimit() + 1, 0);
+        values.assign(historyLimit() + 1, 0);
     }
 
     void reset(const Tval value) {
-        for (auto stat : stats) {
-            stat.reset(value);
-        }
+        rebuild(std::vector<Tval>(stored, value));
     }
 
     void truncate(const unsigned long size) {
         unsigned long remaining = size;
 
-        for (auto it = stats.begin(); it != stats.end(); it++) {
-            it->truncate(remaining);
+        for (auto& window : stats) {
+            window.count = std::min(window.count, remaining);
 
-            const unsigned long window = it->windowSize();
-            const unsigned long change = std::min(remaining, window);
-
-            remaining -= change;
+            if (chained) {
+                remaining -= window.count;
+            }
         }
+
+        updateStored();
     }
 
     void push(const Tval value) {
-        typename WindowStats<Tval, Tagg>::Sample carry;
+        if (stored == 0) {
+            // empty history, start the prefix sums around the first value
+            reference = value;
+            prefixSum[slot(pushes)] = 0;
+            prefixSquaredSum[slot(pushes)] = 0;
+        }
+
+        const Tval shifted = value - reference;
+        const Tval sum = prefixSum[slot(pushes)] + shifted;
+        const Tval squaredSum = prefixSquaredSum[slot(pushes)] + shifted * shifted;
+
+        pushes++;
+
+        prefixSum[slot(pushes)] = sum;
+        prefixSquaredSum[slot(pushes)] = squaredSum;
+        values[slot(pushes)] = value;
+
+        for (auto& window : stats) {
+            if (window.count < window.sizeLimit) {
+                window.count++;
 
-        carry.value = value;
-        carry.valid = true;
+                if (chained) {
+                    break; // value is carried on by full windows only
+                }
+            }
+        }
+
+        updateStored();
 
-        for (auto it = stats.begin(); carry.valid && it != stats.end(); it++) {
-            carry = it->push(carry.value);
+        if (pushes % prefixSum.size() == 0) {
+            rebase();
         }
     }
 
-public:
+    void writeSnapshot(SnapshotWriter& snapshot) const {
+        std::vector<Tval> sums;
+        std::vector<Tval> squaredSums;
+        std::vector<Tval> retained;
 
-    std::vector<RunningWindowStats<Tval, Tagg>> stats;
+        for (uint64_t k = pushes - stored; k <= pushes; k++) {
+            sums.push_back(prefixSum[slot(k)]);
+            squaredSums.push_back(prefixSquaredSum[slot(k)]);
+            retained.push_back(values[slot(k)]);
+        }
 
-};
+        snapshot.value("windowStatsCount", stats.size());
 
-template<typename Tval, typename Tagg = double>
-class OverlappingRunningWindowStats {
+        for (const auto& window : stats) {
+            snapshot.value("windowState", window.sizeLimit, window.count);
+        }
+
+        snapshot.value("windowHistory", pushes, stored);
+        // prefix sums are stored as well, recomputing them would change rounding
+        snapshot.value("windowReference", reference);
+        snapshot.values("windowPrefixSums", sums);
+        snapshot.values("windowPrefixSquaredSums", squaredSums);
+        snapshot.values("windowValues", retained);
+    }
+
+    void readSnapshot(SnapshotReader& snapshot) {
+        size_t count;
+        std::vector<Tval> sums;
+        std::vector<Tval> squaredSums;
+        std::vector<Tval> retained;
+
+        snapshot.value("windowStatsCount", count);
+        stats.resize(count);
+        bindWindows();
+
+        for (auto& window : stats) {
+            snapshot.value("windowState", window.sizeLimit, window.count);
+        }
+
+        snapshot.value("windowHistory", pushes, stored);
+        snapshot.value("windowReference", reference);
+        snapshot.values("windowPrefixSums", sums);
+        snapshot.values("windowPrefixSquaredSums", squaredSums);
+        snapshot.values("windowValues", retained);
+
+        assert(sums.size() == stored + 1 && squaredSums.size() == stored + 1 && retained.size() == stored + 1);
+
+        prefixSum.assign(historyLimit() + 1, 0);
+        prefixSquaredSum.assign(historyLimit() + 1, 0);
+        values.assign(historyLimit() + 1, 0);
+
+        for (unsigned long i = 0; i <= stored; i++) {
+            prefixSum[slot(pushes - stored + i)] = sums[i];
+            prefixSquaredSum[slot(pushes - stored + i)] = squaredSums[i];
+            values[slot(pushes - stored + i)] = retained[i];
+        }
+    }
 
 public:
 
-    OverlappingRunningWindowStats(uint numStats) {
-        stats.resize(numStats);
+    std::vector<Window> stats;
 
-        reset();
+protected:
+
+    void bindWindows() {
+        for (unsigned int i = 0; i < stats.size(); i++) {
+            stats[i].owner = this;
+            stats[i].index = i;
+        }
     }
 
-    void reset() {
-        for (auto stat : stats) {
-            stat.reset();
+    // number of values which have to be retained for all windows
+    unsigned long historyLimit() const {
+        unsigned long result = 0;
+
+        for (const auto& window : stats) {
+            result = chained ? result + window.sizeLimit : std::max(result, window.sizeLimit);
         }
+
+        return result;
     }
 
-    void reset(const Tval value) {
-        for (auto stat : stats) {
-            stat.reset(value);
+    void updateStored() {
+        stored = 0;
+
+        for (const auto& window : stats) {
+            stored = chained ? stored + window.count : std::max(stored, window.count);
         }
     }
 
-    void truncate(const unsigned long size) {
-        for (auto it = stats.begin(); it != stats.end(); it++) {
-            it->truncate(size);
+    // age of the most recent value of the window
+    unsigned long windowStart(const unsigned int index) const {
+        unsigned long start = 0;
+
+        for (unsigned int i = 0; chained && i < index; i++) {
+            start += stats[i].count;
         }
+
+        return start;
     }
 
-    void push(const Tval value) {
-        typename WindowStats<Tval, Tagg>::Sample carry;
-        for (auto it = stats.begin(); it != stats.end(); it++) {
-            it->push(value);
+    unsigned long slot(const uint64_t k) const {
+        return k % prefixSum.size();
+    }
+
+    Tval rangeSum(const std::vector<Tval>& prefix, const unsigned long start, const unsigned long count) const {
+        const uint64_t end = pushes - start;
+
+        return prefix[slot(end)] - prefix[slot(end - count)];
+    }
+
+    void resizeWindow(const unsigned int index, const unsigned long size) {
+        assert(size > 1);
+
+        Window& window = stats[index];
+
+        if (window.count > size) {
+            const unsigned long start = windowStart(index);
+            const unsigned long end = start + window.count;
+
+            window.count = size;
+
+            if (chained && end < stored) {
+                // the dropped values are followed by older windows, thus
+                // they have to be removed from the middle of the history
+                std::vector<Tval> retained = history();
+
+                retained.erase(retained.begin() + start + size, retained.begin() + end);
+                window.sizeLimit = size;
+
+                rebuild(retained);
+
+                return;
+            }
+        }
+
+        window.sizeLimit = size;
+
+        updateStored();
+        reallocate();
+    }
+
+    // retained values, most recent value first
+    std::vector<Tval> history() const {
+        std::vector<Tval> result;
+
+        for (unsigned long age = 0; age < stored; age++) {
+            result.push_back(values[slot(pushes - age)]);
+        }
+
+        return result;
+    }
+
+    // restarts the history with the given values, most recent value first
+    void rebuild(const std::vector<Tval>& history) {
+        stored = history.size();
+        pushes = stored;
+
+        prefixSum.assign(historyLimit() + 1, 0);
+        prefixSquaredSum.assign(prefixSum.size(), 0);
+        values.assign(prefixSum.size(), 0);
+
+        for (uint64_t k = 1; k <= pushes; k++) {
+            values[slot(k)] = history[stored - k];
+        }
+
+        rebase();
+    }
+
+    void reallocate() {
+        const unsigned long capacity = historyLimit() + 1;
+
+        if (capacity == prefixSum.size()) {
+            return;
+        }
+
+        std::vector<Tval> sums(capacity, 0);
+        std::vector<Tval> squaredSums(capacity, 0);
+        std::vector<Tval> retained(capacity, 0);
+
+        for (uint64_t k = pushes - stored; k <= pushes; k++) {
+            sums[k % capacity] = prefixSum[slot(k)];
+            squaredSums[k % capacity] = prefixSquaredSum[slot(k)];
+            retained[k % capacity] = values[slot(k)];
+        }
+
+        prefixSum.swap(sums);
+        prefixSquaredSum.swap(squaredSums);
+        values.swap(retained);
+    }
+
+    // recomputes the prefix sums of the retained values around their mean
+    void rebase() {
+        const uint64_t base = pushes - stored;
+        Tval total = 0;
+
+        for (uint64_t k = base + 1; k <= pushes; k++) {
+            total += values[slot(k)];
+        }
+
+        reference = stored > 0 ? total / stored : 0;
+
+        prefixSum[slot(base)] = 0;
+        prefixSquaredSum[slot(base)] = 0;
+
+        for (uint64_t k = base + 1; k <= pushes; k++) {
+            const Tval shifted = values[slot(k)] - reference;
+
+            prefixSum[slot(k)] = prefixSum[slot(k - 1)] + shifted;
+            prefixSquaredSum[slot(k)] = prefixSquaredSum[slot(k - 1)] + shifted * shifted;
         }
     }
 
+    bool chained;
+
+    // prefix sums of all values pushed so far, shifted by reference. the sums
+    // up to the k-th value are kept at k % size() for the retained values,
+    // the k-th value itself at the same position
+    std::vector<Tval> prefixSum;
+    std::vector<Tval> prefixSquaredSum;
+    std::vector<Tval> values;
+    Tval reference = 0;
+    uint64_t pushes = 0;
+    // number of retained values
+    unsigned long stored = 0;
+
+};
+
+template<typename Tval, typename Tagg = double>
+class ChainedRunningWindowStats : public SharedRunningWindowStats<Tval, Tagg> {
+
+public:
+
+    ChainedRunningWindowStats(uint numStats) : SharedRunningWindowStats<Tval, Tagg>(numStats, true) { }
+
+};
+
+template<typename Tval, typename Tagg = double>
+class OverlappingRunningWindowStats : public SharedRunningWindowStats<Tval, Tagg> {
+
 public:
 
-    std::vector<RunningWindowStats<Tval, Tagg>> stats;
+    OverlappingRunningWindowStats(uint numStats) : SharedRunningWindowStats<Tval, Tagg>(numStats, false) { }
 
 };
 
@@ -15,11 +15,14 @@
 
 #include "NcsContext.h"
 #include "NcsCpsApp.h"
+#include "NcsTickScheduler.h"
 #include "messages/NcsCtrlMsg_m.h"
 
 #include <inet/common/InitStages.h>
 #include <inet/networklayer/common/L3AddressResolver.h>
 
+#include <fstream>
+
 Define_Module(NcsContext);
 
 const std::string NcsContext::NCS_ACTUATOR = "actuator";
@@ -28,6 +31,8 @@ const std::string NcsContext::NCS_SENSOR = "sensor";
 const std::string * NcsContext::NCS_NAMES[] = { &NCS_ACTUATOR, &NCS_CONTROLLER, &NCS_SENSOR };
 
 int NcsContext::ncsIdCounter = 1;
+QuantileSketch NcsContext::networkDelaySketch[NCTXP_COUNT];
+int NcsContext::delaySketchContexts = 0;
 
 
 
@@ -71,6 +76,20 @@ void NcsContext::initialize(const int stage) {
         maxSampleBins = par("maxSampleBins").intValue();
         reportUnusedStepsAsLoss = par("reportUnusedStepsAsLoss").boolValue();
         pktStatisticsStartDelay = par("pktStatisticsStartDelay").doubleValue();
+        useTickScheduler = par("useTickScheduler").boolValue();
+        recordImplCallLatency = par("recordImplCallLatency").boolValue();
+        recordDelayQuantiles = par("recordDelayQuantiles").boolValue();
+        delayQuantiles = cStringTokenizer(par("delayQuantiles").stringValue()).asDoubleVector();
+        delaySketchAccuracy = par("delaySketchAccuracy").doubleValue();
+        saveSnapshotFile = par("saveSnapshotFile").stdstringValue();
+        saveSnapshotTime = par("saveSnapshotTime").doubleValue();
+        restoreSnapshotFile = par("restoreSnapshotFile").stdstringValue();
+
+        // resolve gates once, avoids building gate names for each packet
+        for (int i = NCTXCI_ACTUATOR; i < NCTXCI_COUNT; i++) {
+            cpsIn[i] = gate((*NCS_NAMES[i] + "$i").c_str());
+            cpsOut[i] = gate((*NCS_NAMES[i] + "$o").c_str());
+        }
 
         // setup signals for statistics recording
         scSentSignal = registerSignal("sc_sent");
@@ -82,10 +101,47 @@ void NcsContext::initialize(const int stage) {
         acActualDelaySignal = registerSignal("ac_delay_act");
 
         controlPeriodSignal = registerSignal("controlPeriod_s");
+
+        if (recordDelayQuantiles) {
+            for (const double q : delayQuantiles) {
+                if (q < 0 || q > 1) {
+                    error("delayQuantiles must be within [0, 1]");
+                }
+            }
+
+            const long sketchMaxBins = par("delaySketchMaxBins").intValue();
+
+            if (delaySketchAccuracy <= 0 || delaySketchAccuracy >= 1) {
+                error("delaySketchAccuracy must be within (0, 1)");
+            }
+
+            if (sketchMaxBins < 1) {
+                error("delaySketchMaxBins violates constraint 1 <= %ld", sketchMaxBins);
+            }
+            delaySketchMaxBins = static_cast<unsigned int>(sketchMaxBins);
+
+            for (int i = NCTXP_SC; i < NCTXP_COUNT; i++) {
+                delaySketch[i] = QuantileSketch(delaySketchAccuracy, delaySketchMaxBins);
+                // reset at the beginning of each simulation, like the ncsIdCounter
+                networkDelaySketch[i] = QuantileSketch(delaySketchAccuracy, delaySketchMaxBins);
+            }
+
+            delaySketchContexts = 0;
+        }
         break;
     case INITSTAGE_LOCAL + 1: {
         ncsId = ncsIdCounter++; // draw an identifier
 
+        if (recordDelayQuantiles) {
+            // network-wide sketches can only be merged with identical configuration
+            if (networkDelaySketch[0].relativeAccuracy() != delaySketchAccuracy
+                    || networkDelaySketch[0].maxBins() != delaySketchMaxBins) {
+                error("delaySketchAccuracy and delaySketchMaxBins must be the same for all NCS");
+            }
+
+            delaySketchContexts++;
+        }
+
         // Prepare Parameters for NCS
         ncsParameters = createParameters();
 
@@ -110,11 +166,42 @@ void NcsContext::initialize(const int stage) {
         nextControlStep = startupDelay + controlPeriod;
         nextPlantStep = startupDelay + plantPeriod;
 
-        cMessage * const tickerMsg = new cMessage("NcsTickerEvent", NCTXMK_TICKER_EVT);
+        if (!saveSnapshotFile.empty() || !restoreSnapshotFile.empty()) {
+            if (!ncs->supportsSnapshots()) {
+                error("NCS implementation %s does not support snapshots", ncsImplName.c_str());
+            }
+        }
+
+        if (!restoreSnapshotFile.empty()) {
+            restoreSnapshot();
+        }
+
+        updatePlantWakeup();
+
+        tickerActive = true;
 
-        scheduleAt(std::min(nextPlantStep, nextControlStep), tickerMsg);
+        if (useTickScheduler) {
+            tickScheduler = NcsTickScheduler::findScheduler();
+
+            if (!tickScheduler) {
+                error("useTickScheduler is enabled, but no NcsTickScheduler module exists in the network");
+            }
 
-        if (pktStatisticsStartDelay > SIMTIME_ZERO) {
+            tickScheduler->registerContext(this, getNextTickTime());
+        } else {
+            tickerMsg = new cMessage("NcsTickerEvent", NCTXMK_TICKER_EVT);
+
+            scheduleAt(getNextTickTime(), tickerMsg);
+        }
+
+        if (!saveSnapshotFile.empty()) {
+            cMessage * const snapshotMsg = new cMessage("NcsSnapshotEvent", NCTXMK_SNAPSHOT_EVT);
+
+            scheduleAt(saveSnapshotTime, snapshotMsg);
+        }
+
+        // a restored snapshot taken after the statistics start already contains the reset statistics
+        if (pktStatisticsStartDelay > SIMTIME_ZERO && pktStatisticsStartDelay >= restoredSnapshotTime) {
             cMessage * const statisticsStartup = new cMessage("NcsPktStatisticsStartEvent", NCTXMK_STARTUP_STATS_EVT);
 
             scheduleAt(pktStatisticsStartDelay, statisticsStartup);
@@ -139,6 +226,13 @@ void NcsContext::initialize(const int stage) {
     }
 }
 
+void NcsContext::handleParameterChange(const char * parname) {
+    // parameters are forwarded as cPar to the implementation
+    if (ncs) {
+        ncs->handleNcsParameterChange(parname);
+    }
+}
+
 void NcsContext::finish() {
     EV << "Finish called for NCS with id " << ncsId << endl;
 
@@ -146,6 +240,23 @@ void NcsContext::finish() {
 
     // record NCS statistics and do potential cleanup
     ncs->finishNcs();
+
+    if (recordImplCallLatency) {
+        recordImplCallLatencies();
+    }
+
+    if (recordDelayQuantiles) {
+        recordDelaySketches(this, delaySketch);
+
+        for (int i = NCTXP_SC; i < NCTXP_COUNT; i++) {
+            networkDelaySketch[i].merge(delaySketch[i]);
+        }
+
+        // the last NCS records the merged sketches at network level
+        if (--delaySketchContexts == 0) {
+            recordDelaySketches(getSimulation()->getSystemModule(), networkDelaySketch);
+        }
+    }
 }
 
 void NcsContext::finishNcs() {
@@ -166,43 +277,18 @@ void NcsContext::finishNcs() {
 void NcsContext::handleMessage(cMessage * const msg) {
     if (msg->isSelfMessage()) {
         switch (msg->getKind()) {
-        case NCTXMK_TICKER_EVT: {
-            const simtime_t now = simTime();
-            // call loop with current timestamp, adjusted for the startup delay
-            // thus, NCS code never needs to deal with the time offset
-            const simtime_t ncsSimtime = now - startupDelay;
-
-            if (simulationRuntime > SIMTIME_ZERO && ncsSimtime > simulationRuntime) {
-                delete msg;
-
-                EV_INFO << "runtime limit reached for NCS, stopping periodic ticker" << endl;
-
-                ncsRuntimeLimitReached();
-
-                return;
-            }
+        case NCTXMK_TICKER_EVT:
+            ASSERT(msg == tickerMsg);
 
-            if (now == nextPlantStep) {
-                doPlantStep(ncsSimtime);
-
-                nextPlantStep += plantPeriod;
+            if (processTicker()) {
+                // reschedule ticker-event for next step
+                scheduleAt(getNextTickTime(), msg);
             } else {
-                ASSERT(now == nextControlStep);
-
-                // update delay histogram data
-                scHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
-                caHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
-                acHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
-
-                doControlStep(ncsSimtime);
+                delete msg;
 
-                nextControlStep += controlPeriod;
+                tickerMsg = nullptr;
             }
-
-            // reschedule ticker-event for next step
-            scheduleAt(std::min(nextPlantStep, nextControlStep), msg);
-
-            break; }
+            break;
         case NCTXMK_STARTUP_POLL_EVT:
             if (!setupNCSConnections()) {
                 EV_WARN << "Network is not ready yet, retrying again later" << endl;
@@ -217,6 +303,15 @@ void NcsContext::handleMessage(cMessage * const msg) {
             caHist.resetStats();
             acHist.resetStats();
 
+            for (int i = NCTXP_SC; i < NCTXP_COUNT; i++) {
+                delaySketch[i].reset();
+            }
+
+            delete msg;
+            break;
+        case NCTXMK_SNAPSHOT_EVT:
+            saveSnapshot();
+
             delete msg;
             break;
         default:
@@ -226,9 +321,7 @@ void NcsContext::handleMessage(cMessage * const msg) {
 
             error("Received self-message with unexpected message kind: %i", msgKind);
         }
-    } else if (msg->arrivedOn((NCS_ACTUATOR + "$i").c_str())
-                    || msg->arrivedOn((NCS_CONTROLLER + "$i").c_str())
-                    || msg->arrivedOn((NCS_SENSOR + "$i").c_str())) {
+    } else if (getIndexForGate(msg->getArrivalGateId()) < NCTXCI_COUNT) {
         // packet arriving at a CPS gate
         switch (msg->getKind()) {
         case CpsConnReq: {
@@ -250,7 +343,7 @@ void NcsContext::handleMessage(cMessage * const msg) {
                 error("Received unexpected packet kind at CPS in gate");
             }
 
-            handleNcsPacketFromNetwork(rawPkt);
+            handleNcsPacketFromNetwork(rawPkt, getIndexForGate(rawPkt->getArrivalGateId()));
 
             delete rawPkt;
         }
@@ -263,6 +356,100 @@ void NcsContext::handleMessage(cMessage * const msg) {
     }
 }
 
+simtime_t NcsContext::getNextTickTime() const {
+    return std::min(nextPlantWakeup, nextControlStep);
+}
+
+bool NcsContext::handleSchedulerTick() {
+    Enter_Method_Silent();
+
+    return processTicker();
+}
+
+bool NcsContext::processTicker() {
+    const NcsContextStepType step = prepareStep();
+
+    if (step == NCTXST_NONE) {
+        return false;
+    }
+
+    if (supportsConcurrentSteps()) {
+        computeStep(step);
+    }
+
+    commitStep(step);
+
+    return true;
+}
+
+NcsContextStepType NcsContext::prepareStep() {
+    Enter_Method_Silent();
+
+    const simtime_t now = simTime();
+    // call loop with current timestamp, adjusted for the startup delay
+    // thus, NCS code never needs to deal with the time offset
+    stepNcsTime = now - startupDelay;
+
+    if (simulationRuntime > SIMTIME_ZERO && stepNcsTime > simulationRuntime) {
+        EV_INFO << "runtime limit reached for NCS, stopping periodic ticker" << endl;
+
+        tickerActive = false;
+
+        ncsRuntimeLimitReached();
+
+        return NCTXST_NONE;
+    }
+
+    // pending (potentially coalesced) plant steps are always done first
+    if (now >= nextPlantStep) {
+        stepNcsTime = nextPlantStep - startupDelay;
+        stepPlantCount = getPendingPlantSteps();
+
+        return NCTXST_PLANT;
+    }
+
+    ASSERT(now == nextControlStep);
+
+    // update delay histogram data
+    scHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
+    caHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
+    acHist.prune(now, maxSampleAge, minSampleCount, maxSampleCount);
+
+    return NCTXST_CONTROL;
+}
+
+bool NcsContext::supportsConcurrentSteps() const {
+    return ncs->supportsConcurrentSteps();
+}
+
+void NcsContext::computeStep(const NcsContextStepType step) {
+    // no context switch here, this may be called from a worker thread
+    // the latency histograms are per context and only touched by one thread at a time
+    const uint64_t callStart = recordImplCallLatency ? LatencyHistogram::now() : 0;
+
+    if (step == NCTXST_PLANT) {
+        ncs->computePlantStep(stepNcsTime, stepPlantCount);
+    } else {
+        ncs->computeControlStep(stepNcsTime);
+    }
+
+    if (recordImplCallLatency) {
+        implCallLatency[step == NCTXST_PLANT ? NCTXIC_PLANT_COMPUTE : NCTXIC_CONTROL_COMPUTE].add(LatencyHistogram::now() - callStart);
+    }
+}
+
+void NcsContext::commitStep(const NcsContextStepType step) {
+    Enter_Method_Silent();
+
+    if (step == NCTXST_PLANT) {
+        catchUpPlantSteps();
+    } else {
+        doControlStep(stepNcsTime);
+
+        nextControlStep += controlPeriod;
+    }
+}
+
 NcsContext::NcsDelays NcsContext::computeDelays() {
     NcsContext::NcsDelays result;
     const simtime_t now = simTime();
@@ -337,14 +524,38 @@ AbstractNcsImpl* NcsContext::createNcsImpl(const std::string name) {
 }
 
 void NcsContext::doPlantStep(const simtime_t& ncsTime) {
+    const uint64_t callStart = recordImplCallLatency ? LatencyHistogram::now() : 0;
+
     ncs->doPlantStep(ncsTime, ncsPlantStepResult);
 
+    if (recordImplCallLatency) {
+        implCallLatency[NCTXIC_PLANT_STEP].add(LatencyHistogram::now() - callStart);
+    }
+
     processPlantStepResult(ncsTime, ncsPlantStepResult);
 }
 
+void NcsContext::doPlantSteps(const simtime_t& ncsTimeFrom, const unsigned long count) {
+    const uint64_t callStart = recordImplCallLatency ? LatencyHistogram::now() : 0;
+
+    ncs->doPlantSteps(ncsTimeFrom, count, ncsPlantStepResult);
+
+    if (recordImplCallLatency) {
+        implCallLatency[NCTXIC_PLANT_STEP].add(LatencyHistogram::now() - callStart);
+    }
+
+    processPlantStepResult(ncsTimeFrom, ncsPlantStepResult);
+}
+
 void NcsContext::doControlStep(const simtime_t& ncsTime) {
+    const uint64_t callStart = recordImplCallLatency ? LatencyHistogram::now() : 0;
+
     ncs->doControlStep(ncsTime, ncsControlStepResult);
 
+    if (recordImplCallLatency) {
+        implCallLatency[NCTXIC_CONTROL_STEP].add(LatencyHistogram::now() - callStart);
+    }
+
     processControlStepResult(ncsTime, ncsControlStepResult);
 }
 
@@ -371,6 +582,71 @@ void NcsContext::processControlStepResult(const simtime_t& ncsTime, const NcsCon
     }
 }
 
+void NcsContext::catchUpPlantSteps() {
+    // all plant steps up to now, in one call if more than one is pending
+    const unsigned long count = getPendingPlantSteps();
+
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1) {
+        doPlantStep(nextPlantStep - startupDelay);
+    } else {
+        doPlantSteps(nextPlantStep - startupDelay, count);
+    }
+
+    nextPlantStep += plantPeriod * count;
+
+    updatePlantWakeup();
+}
+
+unsigned long NcsContext::getPendingPlantSteps() const {
+    const simtime_t now = simTime();
+
+    if (nextPlantStep > now) {
+        return 0;
+    }
+
+    return (now - nextPlantStep).raw() / plantPeriod.raw() + 1;
+}
+
+void NcsContext::updatePlantWakeup() {
+    const simtime_t nextStepNcsTime = nextPlantStep - startupDelay;
+    const simtime_t wakeupNcsTime = ncs->getNextPlantWakeup(nextStepNcsTime);
+
+    if (wakeupNcsTime <= nextStepNcsTime) {
+        nextPlantWakeup = nextPlantStep;
+
+        return;
+    }
+
+    // align wakeup to the plant step grid, without overflowing simtime
+    const int64_t periodRaw = plantPeriod.raw();
+    const int64_t stepsAhead = ((wakeupNcsTime - nextStepNcsTime).raw() + periodRaw - 1) / periodRaw;
+
+    if (stepsAhead > (SIMTIME_MAX - nextPlantStep).raw() / periodRaw) {
+        nextPlantWakeup = SIMTIME_MAX;
+    } else {
+        nextPlantWakeup = nextPlantStep + plantPeriod * stepsAhead;
+    }
+}
+
+void NcsContext::rescheduleTicker() {
+    if (!tickerActive) {
+        return;
+    }
+
+    const simtime_t next = getNextTickTime();
+
+    if (tickScheduler) {
+        tickScheduler->registerContext(this, next);
+    } else if (tickerMsg->getArrivalTime() != next) {
+        cancelEvent(tickerMsg);
+        scheduleAt(next, tickerMsg);
+    }
+}
+
 void NcsContext::handleControllerFailure() {
     switch (actionOnControllerFailure) {
     case NCTXCFA_FINISH:
@@ -384,7 +660,131 @@ void NcsContext::handleControllerFailure() {
     }
 }
 
-NcsContext::CommunicationStatus NcsContext::sendNcsPacketsToNetwork(const std::vector<NcsPkt> pkts) {
+void NcsContext::recordImplCallLatencies() {
+    static const char * const callNames[] = { "implPlantStep", "implControlStep", "implHandlePacket",
+            "implPlantCompute", "implControlCompute" };
+
+    // the computation-only part of the steps exists for split steps only
+    const int callCount = supportsConcurrentSteps() ? NCTXIC_COUNT : NCTXIC_PLANT_COMPUTE;
+
+    for (int i = NCTXIC_PLANT_STEP; i < callCount; i++) {
+        const LatencyHistogram& hist = implCallLatency[i];
+        const std::string name = callNames[i];
+
+        recordScalar((name + "Calls").c_str(), hist.count());
+        recordScalar((name + "LatencyP50").c_str(), hist.quantile(0.5) * 1E-9, "s");
+        recordScalar((name + "LatencyP99").c_str(), hist.quantile(0.99) * 1E-9, "s");
+        recordScalar((name + "LatencyMax").c_str(), hist.max() * 1E-9, "s");
+    }
+}
+
+void NcsContext::recordDelaySketches(cComponent * const target, const QuantileSketch sketches[]) {
+    static const char * const pathNames[] = { "sc", "ca", "ac" };
+
+    for (int i = NCTXP_SC; i < NCTXP_COUNT; i++) {
+        const QuantileSketch& sketch = sketches[i];
+        const std::string name = std::string(pathNames[i]) + "_delay";
+
+        target->recordScalar((name + "Count").c_str(), sketch.count());
+
+        for (const double q : delayQuantiles) {
+            char quantileName[32];
+
+            snprintf(quantileName, sizeof(quantileName), "P%g", q * 100);
+            target->recordScalar((name + quantileName).c_str(), sketch.quantile(q), "s");
+        }
+
+        target->recordScalar((name + "Max").c_str(), sketch.max(), "s");
+    }
+}
+
+std::string NcsContext::getSnapshotFileName(const std::string& prefix) const {
+    return prefix + "." + std::to_string(ncsId) + ".snapshot";
+}
+
+void NcsContext::saveSnapshot() {
+    const std::string fileName = getSnapshotFileName(saveSnapshotFile);
+    std::ofstream file(fileName);
+
+    if (!file) {
+        error("Unable to open snapshot file %s for writing", fileName.c_str());
+    }
+
+    SnapshotWriter snapshot(file);
+
+    writeSnapshot(snapshot);
+
+    snapshot.section(ncsImplName);
+    ncs->writeSnapshot(snapshot);
+
+    if (!file) {
+        error("Failed to write snapshot file %s", fileName.c_str());
+    }
+
+    EV_INFO << "saved snapshot of NCS " << ncsId << " to " << fileName << endl;
+}
+
+void NcsContext::restoreSnapshot() {
+    const std::string fileName = getSnapshotFileName(restoreSnapshotFile);
+    std::ifstream file(fileName);
+
+    if (!file) {
+        error("Unable to open snapshot file %s", fileName.c_str());
+    }
+
+    SnapshotReader snapshot(file);
+
+    readSnapshot(snapshot);
+
+    snapshot.section(ncsImplName);
+    ncs->readSnapshot(snapshot);
+
+    EV_INFO << "restored NCS " << ncsId << " from snapshot " << fileName
+            << ", next steps at t=" << nextPlantStep << " and t=" << nextControlStep << endl;
+}
+
+void NcsContext::writeSnapshot(SnapshotWriter& snapshot) {
+    snapshot.section("NcsContext");
+
+    snapshot.value("ncsId", ncsId);
+    snapshot.value("snapshotTime", simTime());
+    snapshot.value("startupDelay", startupDelay);
+    snapshot.value("periods", plantPeriod, controlPeriod);
+    snapshot.value("nextSteps", nextPlantStep, nextControlStep);
+    snapshot.value("admissible", plantStateAdmissible, controllerStateAdmissible);
+
+    scHist.writeSnapshot(snapshot);
+    caHist.writeSnapshot(snapshot);
+    acHist.writeSnapshot(snapshot);
+}
+
+void NcsContext::readSnapshot(SnapshotReader& snapshot) {
+    int snapshotNcsId;
+    simtime_t snapshotTime;
+    simtime_t snapshotStartupDelay;
+
+    snapshot.section("NcsContext");
+
+    snapshot.value("ncsId", snapshotNcsId);
+    snapshot.value("snapshotTime", snapshotTime);
+    snapshot.value("startupDelay", snapshotStartupDelay);
+
+    if (snapshotNcsId != ncsId || snapshotStartupDelay != startupDelay) {
+        error("Snapshot does not match the NCS configuration (ncsId %i, startupDelay %s)", ncsId, startupDelay.str().c_str());
+    }
+
+    restoredSnapshotTime = snapshotTime;
+
+    snapshot.value("periods", plantPeriod, controlPeriod);
+    snapshot.value("nextSteps", nextPlantStep, nextControlStep);
+    snapshot.value("admissible", plantStateAdmissible, controllerStateAdmissible);
+
+    scHist.readSnapshot(snapshot);
+    caHist.readSnapshot(snapshot);
+    acHist.readSnapshot(snapshot);
+}
+
+NcsContext::CommunicationStatus NcsContext::sendNcsPacketsToNetwork(const std::vector<NcsPkt>& pkts) {
     CommunicationStatus cs = CommunicationStatus{false, false, false};
 
     if (networkConfigured) {
@@ -449,10 +849,10 @@ void NcsContext::sendNcsPacketToNetwork(const NcsPkt& ncsPkt, CommunicationStatu
             << " bytes ctx payload out from " << NCS_NAMES[srcIndex]->c_str()
             << " to " << NCS_NAMES[dstIndex]->c_str() << endl;
 
-    send(rawPkt, (*NCS_NAMES[srcIndex] + "$o").c_str()); // forward pkt to sending CPS
+    send(rawPkt, cpsOut[srcIndex]); // forward pkt to sending CPS
 }
 
-void NcsContext::handleNcsPacketFromNetwork(RawPacket* const rawPkt) {
+void NcsContext::handleNcsPacketFromNetwork(RawPacket* const rawPkt, const NcsContextComponentIndex dst) {
     NcsSendData * const info = dynamic_cast<NcsSendData *>(rawPkt->getControlInfo());
     const size_t payloadSize = rawPkt->getByteArray().getDataArraySize();
 
@@ -462,9 +862,12 @@ void NcsContext::handleNcsPacketFromNetwork(RawPacket* const rawPkt) {
     const simtime_t now = simTime();
     const simtime_t ncsSimtime = (now - startupDelay);
 
+    // the receiving CPS is known from the arrival gate
+    ASSERT(dst == getIndexForAddr(info->getDstAddr()));
+
     NcsPkt ncsPkt = NcsPkt{
         getIndexForAddr(info->getSrcAddr()),
-        getIndexForAddr(info->getDstAddr()),
+        dst,
         0, // unknown
         false, // to be computed
         rawPkt
@@ -475,8 +878,23 @@ void NcsContext::handleNcsPacketFromNetwork(RawPacket* const rawPkt) {
                 << NCS_NAMES[ncsPkt.src]->c_str() << " to " << NCS_NAMES[ncsPkt.dst]->c_str() << endl;
 
 
+    // bring deferred plant steps up to date before the packet is processed
+    // plant steps executed in time are left to the ticker, as before
+    if (tickerActive && nextPlantWakeup > nextPlantStep && nextPlantStep <= now) {
+        catchUpPlantSteps();
+        rescheduleTicker();
+    }
+
     // forward to NCS model
-    std::vector<NcsContext::NcsPkt> pktList = ncs->handlePacket(ncsSimtime, ncsPkt);
+    replyPkts.clear();
+
+    const uint64_t callStart = recordImplCallLatency ? LatencyHistogram::now() : 0;
+
+    ncs->handlePacket(ncsSimtime, ncsPkt, replyPkts);
+
+    if (recordImplCallLatency) {
+        implCallLatency[NCTXIC_HANDLE_PACKET].add(LatencyHistogram::now() - callStart);
+    }
 
     const simtime_t pktDelay = now - rawPkt->getCreationTime();
     const uint64_t pktId = ncsPkt.pktId;
@@ -484,23 +902,35 @@ void NcsContext::handleNcsPacketFromNetwork(RawPacket* const rawPkt) {
     if (ncsPkt.dst == NCTXCI_ACTUATOR) {
         emit(caActualDelaySignal, pktDelay);
         caHist.received(pktId, now);
+
+        if (recordDelayQuantiles) {
+            delaySketch[NCTXP_CA].add(pktDelay.dbl());
+        }
     } else if (ncsPkt.dst == NCTXCI_CONTROLLER) {
         if (!ncsPkt.isAck) {
             // regular data packet from sensor to controller
             emit(scActualDelaySignal, pktDelay);
             scHist.received(pktId, now);
+
+            if (recordDelayQuantiles) {
+                delaySketch[NCTXP_SC].add(pktDelay.dbl());
+            }
         } else {
             // ACK packet sent back from actuator
             emit(acActualDelaySignal, pktDelay);
             acHist.received(pktId, now);
+
+            if (recordDelayQuantiles) {
+                delaySketch[NCTXP_AC].add(pktDelay.dbl());
+            }
         }
     }
 
     EV_INFO << "pktId " << pktId << " in with delay " << pktDelay << endl;
 
     // and push replies back into the network
-    if (pktList.size() > 0) {
-        sendNcsPacketsToNetwork(pktList);
+    if (!replyPkts.empty()) {
+        sendNcsPacketsToNetwork(replyPkts);
     }
 }
 
@@ -566,10 +996,10 @@ void NcsContext::connect(const NcsContextComponentIndex dst) {
 
     msg->setControlInfo(req);
 
-    send(msg, (*NCS_NAMES[NCTXCI_CONTROLLER] + "$o").c_str());
+    send(msg, cpsOut[NCTXCI_CONTROLLER]);
 }
 
-NcsContextComponentIndex NcsContext::getIndexForAddr(const L3Address &addr) {
+NcsContextComponentIndex NcsContext::getIndexForAddr(const L3Address &addr) const {
     for (int i = NCTXCI_ACTUATOR; i < NCTXCI_COUNT; i++) {
         if (cpsAddr[i] == addr) {
             return static_cast<NcsContextComponentIndex>(i);
@@ -578,3 +1008,13 @@ NcsContextComponentIndex NcsContext::getIndexForAddr(const L3Address &addr) {
 
     return NCTXCI_COUNT;
 }
+
+NcsContextComponentIndex NcsContext::getIndexForGate(const int gateId) const {
+    for (int i = NCTXCI_ACTUATOR; i < NCTXCI_COUNT; i++) {
+        if (cpsIn[i]->getId() == gateId) {
+            return static_cast<NcsContextComponentIndex>(i);
+        }
+    }
+
+    return NCTXCI_COUNT;
+}
@@ -22,6 +22,9 @@
 #include <inet/networklayer/common/L3Address.h>
 
 #include "util/HistogramCollector.h"
+#include "util/LatencyHistogram.h"
+#include "util/QuantileSketch.h"
+#include "util/Snapshot.h"
 
 using namespace omnetpp;
 using namespace inet;
@@ -29,7 +32,8 @@ using namespace inet;
 enum NcsContextMessageKind {
     NCTXMK_TICKER_EVT = 2300,
     NCTXMK_STARTUP_POLL_EVT,
-    NCTXMK_STARTUP_STATS_EVT
+    NCTXMK_STARTUP_STATS_EVT,
+    NCTXMK_SNAPSHOT_EVT
 };
 
 enum NcsContextComponentIndex {
@@ -39,6 +43,28 @@ enum NcsContextComponentIndex {
     NCTXCI_COUNT
 };
 
+enum NcsContextStepType {
+    NCTXST_NONE = 0,
+    NCTXST_PLANT,
+    NCTXST_CONTROL
+};
+
+enum NcsContextImplCall {
+    NCTXIC_PLANT_STEP = 0,
+    NCTXIC_CONTROL_STEP,
+    NCTXIC_HANDLE_PACKET,
+    NCTXIC_PLANT_COMPUTE,   // computation-only part of split steps, see AbstractNcsImpl::supportsConcurrentSteps()
+    NCTXIC_CONTROL_COMPUTE,
+    NCTXIC_COUNT
+};
+
+enum NcsContextPath {
+    NCTXP_SC = 0,
+    NCTXP_CA,
+    NCTXP_AC,
+    NCTXP_COUNT
+};
+
 enum NcsContextControllerFailureAction {
     NCTXCFA_IGNORE = 0,
     NCTXCFA_FINISH,
@@ -47,8 +73,11 @@ enum NcsContextControllerFailureAction {
 
 // forward declaration
 class AbstractNcsImpl;
+class NcsTickScheduler;
 
 class NcsContext : public cSimpleModule {
+    friend class NcsTickScheduler;
+
   public:
     virtual ~NcsContext();
 
@@ -58,6 +87,7 @@ class NcsContext : public cSimpleModule {
     virtual void finish() override;
     virtual void finishNcs();
     virtual void handleMessage(cMessage * const msg) override;
+    virtual void handleParameterChange(const char * parname) override;
 
     virtual void postNetworkInit() { };
     virtual void postConnect(const NcsContextComponentIndex to) { };
@@ -128,6 +158,10 @@ class NcsContext : public cSimpleModule {
     NcsDelays computeDelays();
     void updateControlPeriod(const simtime_t newControlPeriod); // must only be called from a call context within doControlStep() or processControlStepResult()
 
+    int getNcsId() const { return ncsId; };
+    simtime_t getNextTickTime() const;
+    bool handleSchedulerTick(); // called by NcsTickScheduler, returns false once the periodic ticker is stopped
+
   private:
 
     struct CommunicationStatus {
@@ -136,16 +170,32 @@ class NcsContext : public cSimpleModule {
         bool ac;
     };
 
+    bool processTicker();
+    NcsContextStepType prepareStep();
+    bool supportsConcurrentSteps() const;
+    void computeStep(const NcsContextStepType step); // may run on a worker thread, see AbstractNcsImpl::supportsConcurrentSteps()
+    void commitStep(const NcsContextStepType step);
+    void catchUpPlantSteps();
+    unsigned long getPendingPlantSteps() const;
+    void updatePlantWakeup();
+    void rescheduleTicker();
     void handleControllerFailure();
+    void recordImplCallLatencies();
+    void recordDelaySketches(cComponent * const target, const QuantileSketch sketches[]);
+
+    std::string getSnapshotFileName(const std::string& prefix) const;
+    void saveSnapshot();
+    void restoreSnapshot();
 
     bool setupNCSConnections();
     void connect(const NcsContextComponentIndex dst);
 
-    CommunicationStatus sendNcsPacketsToNetwork(const std::vector<NcsPkt> pkts);
+    CommunicationStatus sendNcsPacketsToNetwork(const std::vector<NcsPkt>& pkts);
     void sendNcsPacketToNetwork(const NcsPkt& ncsPkt, CommunicationStatus& cs);
-    void handleNcsPacketFromNetwork(RawPacket* const rawPkt);
+    void handleNcsPacketFromNetwork(RawPacket* const rawPkt, const NcsContextComponentIndex dst);
 
-    NcsContextComponentIndex getIndexForAddr(const L3Address &addr);
+    NcsContextComponentIndex getIndexForAddr(const L3Address &addr) const;
+    NcsContextComponentIndex getIndexForGate(const int gateId) const;
 
   protected:
 
@@ -156,11 +206,15 @@ class NcsContext : public cSimpleModule {
 
     virtual AbstractNcsImpl* createNcsImpl(const std::string name);
     virtual void doPlantStep(const simtime_t& ncsTime);
+    virtual void doPlantSteps(const simtime_t& ncsTimeFrom, const unsigned long count);
     virtual void doControlStep(const simtime_t& ncsTime);
     virtual void processPlantStepResult(const simtime_t& ncsTime, const NcsPlantStepResult * const result);
     virtual void processControlStepResult(const simtime_t& ncsTime, const NcsControlStepResult * const result);
     virtual void ncsRuntimeLimitReached() { };
 
+    virtual void writeSnapshot(SnapshotWriter& snapshot);
+    virtual void readSnapshot(SnapshotReader& snapshot);
+
   protected:
 
     //
@@ -169,6 +223,13 @@ class NcsContext : public cSimpleModule {
 
     static int ncsIdCounter;
 
+    /**
+     * Delay sketches of all NCS of the network, merged during finish(), and
+     * the number of NCS which still have to contribute.
+     */
+    static QuantileSketch networkDelaySketch[NCTXP_COUNT];
+    static int delaySketchContexts;
+
     /**
      * Actual NCS instance
      */
@@ -219,6 +280,13 @@ class NcsContext : public cSimpleModule {
      */
     simtime_t nextControlStep;
 
+    /**
+     * Time at which pending plant steps have to be executed at the latest,
+     * as declared by the NCS implementation. Equals nextPlantStep unless
+     * the implementation allows to coalesce plant steps.
+     */
+    simtime_t nextPlantWakeup;
+
     /**
      * Determines whether the connections between sensor, controller and actuator are initiated.
      */
@@ -235,6 +303,17 @@ class NcsContext : public cSimpleModule {
      */
     L3Address cpsAddr[NCTXCI_COUNT];
 
+    /**
+     * Gates towards the different NCS components, resolved once during initialization.
+     */
+    cGate * cpsIn[NCTXCI_COUNT];
+    cGate * cpsOut[NCTXCI_COUNT];
+
+    /**
+     * Buffer for packets created by the NCS in response to a received packet, reused for all packets.
+     */
+    std::vector<NcsPkt> replyPkts;
+
     /**
      * Histogram collectors for sensor-controller, controller-actuator and actuator-controller paths.
      */
@@ -253,6 +332,45 @@ class NcsContext : public cSimpleModule {
 
     simsignal_t controlPeriodSignal;
 
+    /**
+     * Wall-clock durations of the calls into the NCS implementation, per call type.
+     * Only recorded if recordImplCallLatency is set.
+     */
+    LatencyHistogram implCallLatency[NCTXIC_COUNT];
+
+    /**
+     * Sketches of the actual packet delays, per path.
+     * Only recorded if recordDelayQuantiles is set.
+     */
+    QuantileSketch delaySketch[NCTXP_COUNT];
+
+    /**
+     * Shared ticker, if enabled. Replaces the local ticker self-message.
+     */
+    NcsTickScheduler * tickScheduler = nullptr;
+
+    /**
+     * Local ticker self-message, if the tick scheduler is not used.
+     */
+    cMessage * tickerMsg = nullptr;
+
+    /**
+     * Periodic ticker still running (i.e. runtime limit not reached yet)?
+     */
+    bool tickerActive = false;
+
+    /**
+     * NCS time of the step prepared by prepareStep(), for plant steps the
+     * NCS time of the first of the stepPlantCount pending plant steps.
+     */
+    simtime_t stepNcsTime;
+    unsigned long stepPlantCount = 0;
+
+    /**
+     * Time at which the restored snapshot was taken, zero if no snapshot was restored.
+     */
+    simtime_t restoredSnapshotTime = SIMTIME_ZERO;
+
   protected:
 
     //
@@ -320,6 +438,33 @@ class NcsContext : public cSimpleModule {
      * point in time at which pkt statistics are reset (for evaluation purposes)
      */
     simtime_t pktStatisticsStartDelay;
+    /**
+     * register at the global NcsTickScheduler instead of scheduling an own ticker event?
+     */
+    bool useTickScheduler;
+    /**
+     * measure the wall-clock duration of calls into the NCS implementation and
+     * record quantiles as scalars at the end of the simulation?
+     */
+    bool recordImplCallLatency;
+    /**
+     * record quantiles of the actual packet delays as scalars at the end of the
+     * simulation, configuration of the underlying quantile sketches
+     */
+    bool recordDelayQuantiles;
+    std::vector<double> delayQuantiles;
+    double delaySketchAccuracy;
+    unsigned int delaySketchMaxBins;
+    /**
+     * file name prefix and point in time for saving a snapshot of the NCS state,
+     * no snapshot is saved if the prefix is empty
+     */
+    std::string saveSnapshotFile;
+    simtime_t saveSnapshotTime;
+    /**
+     * file name prefix of the snapshot to restore the NCS state from during initialization
+     */
+    std::string restoreSnapshotFile;
 };
 
 class AbstractNcsImpl {
@@ -334,7 +479,70 @@ class AbstractNcsImpl {
 
     virtual void doPlantStep(const simtime_t& ncsTime, NcsContext::NcsPlantStepResult * const result) = 0;
     virtual void doControlStep(const simtime_t& ncsTime, NcsContext::NcsControlStepResult * const result) = 0;
-    virtual std::vector<NcsContext::NcsPkt> handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt) = 0;
+    // replies is owned by the context and passed in empty, append potential response packets
+    virtual void handlePacket(const simtime_t& ncsTime, NcsContext::NcsPkt& ncsPkt, std::vector<NcsContext::NcsPkt>& replies) = 0;
+
+    /**
+     * Called whenever a parameter of the NcsContext changed at run-time,
+     * parname is nullptr if the changed parameter is unknown.
+     */
+    virtual void handleNcsParameterChange(const char * parname) { };
+
+    /**
+     * Does the implementation split its steps into a computation-only part
+     * (computePlantStep() / computeControlStep()) and the regular step calls?
+     * If so, the computation-only part is always called right before the
+     * regular step call for the same step(s): computePlantStep() receives
+     * the same start time and count as the subsequent doPlantSteps() call
+     * (or doPlantStep() if count is one). Driven by an NcsTickScheduler
+     * with worker threads, it may run concurrently to other NCS instances.
+     * Thus, it must neither share state with other instances nor access the
+     * simulation kernel, i.e. no logging, RNG access, signal emission or
+     * creation of messages/packets. All of that belongs into doPlantStep() /
+     * doControlStep(), which are still called in ncsId order. Note that the
+     * scheduler then prepares, computes and commits all due steps in three
+     * passes, thus side effects of prepareStep() (e.g. histogram pruning) of
+     * all instances happen before the first commit, unlike serial processing.
+     */
+    virtual bool supportsConcurrentSteps() { return false; };
+
+    /**
+     * NCS time of the next plant step which has to be executed in time, given
+     * the NCS time of the next plant step. Plant steps before are deferred and
+     * caught up by a single doPlantSteps() call, at the latest right before the
+     * next control step, the next received packet or the returned wakeup.
+     * The default requires each plant step to be executed in time.
+     */
+    virtual simtime_t getNextPlantWakeup(const simtime_t& nextPlantStep) { return nextPlantStep; };
+
+    /**
+     * Executes count consecutive plant steps, the first one at NCS time from.
+     * The result reports whether the plant state was admissible in all steps.
+     */
+    virtual void doPlantSteps(const simtime_t& from, const unsigned long count, NcsContext::NcsPlantStepResult * const result) {
+        bool admissible = true;
+
+        for (unsigned long i = 0; i < count; i++) {
+            doPlantStep(from + getPlantPeriod() * i, result);
+
+            admissible = admissible && result->plantStateAdmissible;
+        }
+
+        result->plantStateAdmissible = admissible;
+    };
+
+    virtual void computePlantStep(const simtime_t&, const unsigned long) { };
+    virtual void computeControlStep(const simtime_t&) { };
+
+    /**
+     * Save and restore the implementation state as part of an NcsContext
+     * snapshot. readSnapshot() is called right after initializeNcs().
+     * Implementations which do not support snapshots keep the defaults.
+     */
+    virtual bool supportsSnapshots() { return false; };
+
+    virtual void writeSnapshot(SnapshotWriter& snapshot) { };
+    virtual void readSnapshot(SnapshotReader& snapshot) { };
 };
 
 #endif
@@ -0,0 +1,217 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "NcsTickScheduler.h"
+#include "NcsContext.h"
+
+Define_Module(NcsTickScheduler);
+
+
+NcsTickScheduler::~NcsTickScheduler() {
+    cancelAndDelete(tickerMsg);
+
+    delete workerPool;
+}
+
+void NcsTickScheduler::initialize() {
+    tickerMsg = new cMessage("NcsSchedulerTickerEvent", NTSMK_TICKER_EVT);
+
+    const int numWorkerThreads = par("numWorkerThreads").intValue();
+
+    if (numWorkerThreads < 0) {
+        error("numWorkerThreads must not be negative");
+    }
+
+    if (numWorkerThreads > 0) {
+        workerPool = new WorkerPool(numWorkerThreads);
+    }
+}
+
+void NcsTickScheduler::handleMessage(cMessage * const msg) {
+    if (msg != tickerMsg) {
+        const char * const name = msg->getName();
+
+        delete msg;
+
+        error("Received unexpected message: %s", name);
+    }
+
+    const simtime_t now = simTime();
+
+    // contexts may be due again at the same time (e.g. plant and control step
+    // coincide), thus process the current timestamp until no context is left
+    while (!pendingTicks.empty() && pendingTicks.begin()->first == now) {
+        ContextMap_t due;
+
+        due.swap(pendingTicks.begin()->second);
+        pendingTicks.erase(pendingTicks.begin());
+
+        for (auto &entry : due) {
+            registeredTicks.erase(entry.first);
+        }
+
+        if (workerPool) {
+            processConcurrent(due);
+        } else {
+            processSerial(due);
+        }
+    }
+
+    rescheduleTicker();
+}
+
+void NcsTickScheduler::processSerial(ContextMap_t& due) {
+    for (auto &entry : due) {
+        NcsContext * const context = entry.second;
+
+        if (context->handleSchedulerTick()) {
+            insert(context, context->getNextTickTime());
+        }
+    }
+}
+
+void NcsTickScheduler::processConcurrent(ContextMap_t& due) {
+    std::map<int, NcsContextStepType> steps;
+    std::vector<WorkerPool::Task_t> tasks;
+
+    // prepare all steps which support concurrent computation up front
+    for (auto &entry : due) {
+        NcsContext * const context = entry.second;
+
+        if (context->supportsConcurrentSteps()) {
+            const NcsContextStepType step = context->prepareStep();
+
+            steps[entry.first] = step;
+
+            if (step != NCTXST_NONE) {
+                tasks.push_back([context, step]() { context->computeStep(step); });
+            }
+        }
+    }
+
+    workerPool->run(tasks);
+
+    // commit in ncsId order, remaining contexts are processed as usual
+    for (auto &entry : due) {
+        NcsContext * const context = entry.second;
+        const auto it = steps.find(entry.first);
+        bool active;
+
+        if (it == steps.end()) {
+            active = context->handleSchedulerTick();
+        } else if (it->second != NCTXST_NONE) {
+            context->commitStep(it->second);
+            active = true;
+        } else {
+            active = false;
+        }
+
+        if (active) {
+            insert(context, context->getNextTickTime());
+        }
+    }
+}
+
+void NcsTickScheduler::registerContext(NcsContext * const context, const simtime_t firstTick) {
+    Enter_Method_Silent();
+
+    ASSERT(context);
+
+    unregisterContext(context);
+    insert(context, firstTick);
+
+    rescheduleTicker();
+}
+
+void NcsTickScheduler::unregisterContext(NcsContext * const context) {
+    Enter_Method_Silent();
+
+    const int ncsId = context->getNcsId();
+    const auto it = registeredTicks.find(ncsId);
+
+    if (it == registeredTicks.end()) {
+        return;
+    }
+
+    const auto tickIt = pendingTicks.find(it->second);
+
+    ASSERT(tickIt != pendingTicks.end());
+
+    tickIt->second.erase(ncsId);
+
+    if (tickIt->second.empty()) {
+        pendingTicks.erase(tickIt);
+    }
+
+    registeredTicks.erase(it);
+}
+
+void NcsTickScheduler::insert(NcsContext * const context, const simtime_t tick) {
+    ASSERT(tick >= simTime());
+
+    const int ncsId = context->getNcsId();
+
+    pendingTicks[tick][ncsId] = context;
+    registeredTicks[ncsId] = tick;
+}
+
+void NcsTickScheduler::rescheduleTicker() {
+    if (pendingTicks.empty()) {
+        cancelEvent(tickerMsg);
+
+        return;
+    }
+
+    const simtime_t next = pendingTicks.begin()->first;
+
+    if (tickerMsg->isScheduled()) {
+        if (tickerMsg->getArrivalTime() == next) {
+            return; // already scheduled for the earliest timestamp
+        }
+
+        cancelEvent(tickerMsg);
+    }
+
+    scheduleAt(next, tickerMsg);
+}
+
+NcsTickScheduler* NcsTickScheduler::findScheduler() {
+    static NcsTickScheduler * scheduler = nullptr;
+    static cSimulation * sim = nullptr;
+
+    if (!scheduler || cSimulation::getActiveSimulation() != sim) {
+        NcsTickScheduler::FinderVisitor v;
+
+        sim = cSimulation::getActiveSimulation();
+
+        sim->forEachChild(&v);
+
+        scheduler = v.scheduler;
+    }
+
+    return scheduler;
+}
+
+void NcsTickScheduler::FinderVisitor::visit(cObject *obj) {
+    const std::string className("NcsTickScheduler");
+
+    if (!scheduler && obj) {
+        if (className.compare(obj->getClassName()) == 0) {
+            scheduler = dynamic_cast<NcsTickScheduler*>(obj);
+        } else {
+            obj->forEachChild(this);
+        }
+    }
+}
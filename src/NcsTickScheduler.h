@@ -0,0 +1,94 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __LIBNCS_OMNET_NCSTICKSCHEDULER_H_
+#define __LIBNCS_OMNET_NCSTICKSCHEDULER_H_
+
+#include <omnetpp.h>
+
+#include <map>
+
+#include "util/WorkerPool.h"
+
+using namespace omnetpp;
+
+// forward declaration
+class NcsContext;
+
+enum NcsTickSchedulerMessageKind {
+    NTSMK_TICKER_EVT = 2310
+};
+
+/**
+ * Drives the periodic ticker of all registered NcsContext instances.
+ *
+ * Instead of one ticker event per NcsContext, exactly one event is kept in the
+ * future event set for the earliest pending timestamp. All contexts due at this
+ * timestamp are processed in ascending order of their ncsId.
+ *
+ * With worker threads enabled, the computation-only part of all due steps
+ * (see AbstractNcsImpl::supportsConcurrentSteps()) runs concurrently, while
+ * the steps themselves are still committed one after another in ncsId order.
+ */
+class NcsTickScheduler : public cSimpleModule {
+  public:
+    virtual ~NcsTickScheduler();
+
+    void registerContext(NcsContext * const context, const simtime_t firstTick);
+    void unregisterContext(NcsContext * const context);
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage * const msg) override;
+
+  protected:
+
+    // ncsId --> context, ordered map for deterministic processing order
+    typedef std::map<int, NcsContext *> ContextMap_t;
+    // tick timestamp --> contexts due at that time
+    typedef std::map<simtime_t, ContextMap_t> TickMap_t;
+
+  private:
+    void processSerial(ContextMap_t& due);
+    void processConcurrent(ContextMap_t& due);
+    void insert(NcsContext * const context, const simtime_t tick);
+    void rescheduleTicker();
+
+  protected:
+
+    TickMap_t pendingTicks;
+    // ncsId --> currently registered tick timestamp
+    std::map<int, simtime_t> registeredTicks;
+
+    cMessage * tickerMsg = nullptr;
+
+    /**
+     * Pool for concurrent step computations, nullptr if disabled
+     */
+    WorkerPool * workerPool = nullptr;
+
+  public:
+    static NcsTickScheduler* findScheduler();
+
+  protected:
+    class FinderVisitor : public cVisitor {
+      public:
+        virtual void visit(cObject *obj) override;
+
+        NcsTickScheduler* scheduler = nullptr;
+    };
+};
+
+#endif
@@ -395,16 +395,29 @@ void OracleCCCoordinator::computeLink(Link * const l) {
         double qmDesiredRate_sum = 0;
         double rateMax = 0;
         double rateMin = 0;
+        // rate of flows with their target QM assigned elsewhere, constant during the Newton iteration
+        double fixedRate_sum = 0;
+        // flows for which this link is (probably) the bottleneck, and all others
+        std::vector<Flow*> bottleneckFlows;
+        std::vector<Flow*> fixedFlows;
+
+        bottleneckFlows.reserve(l->flows.size());
 
         for (auto f : l->flows) {
             if (f->flowTargetQM < 0) {
                 qmDesiredRate_sum += f->transport->getQMDesiredRate(f->transportHandle);
 
+                bottleneckFlows.push_back(f);
+
                 EV_DEBUG << "(probably) bottleneck flow: " << f->transport->getFullPath() << endl;
             } else {
+                const double fixedRate = f->transport->getRateForQM(f->transportHandle, f->flowTargetQM);
+
                 // flows which are constrained by some other link do not desire more rate here
-                qmDesiredRate_sum += std::min(f->transport->getQMDesiredRate(f->transportHandle),
-                                              f->transport->getRateForQM(f->transportHandle, f->flowTargetQM));
+                qmDesiredRate_sum += std::min(f->transport->getQMDesiredRate(f->transportHandle), fixedRate);
+                fixedRate_sum += fixedRate;
+
+                fixedFlows.push_back(f);
 
                 EV_DEBUG << "non-bottleneck flow: " << f->transport->getFullPath() << "target QM: " << f->flowTargetQM << endl;
             }
@@ -433,29 +446,16 @@ void OracleCCCoordinator::computeLink(Link * const l) {
         int i = 0;
         double qmTarget = 0.5;
 
-        do {
-            ICoCCTranslator::CoCCLinearization linSum = { 0, 0 };
-
-            for (auto f : l->flows) {
-                ICoCCTranslator::CoCCLinearization lin = { 0, 0 };
-
-                if (f->flowTargetQM < 0) {
-                    lin = f->transport->getLinearizationForQM(f->transportHandle, qmTarget);
-                } else {
-                    // this link is not a bottleneck to this flow
-                    // flows which already have their target QM assigned can not increase their sending rate further
-                    lin.b = f->transport->getRateForQM(f->transportHandle, f->flowTargetQM);
-                }
-
-                linSum.m += lin.m;
-                linSum.b += lin.b;
-            }
+        // the linearization at qmTarget also yields the exact rate at qmTarget (m * qmTarget + b),
+        // hence each iteration requires a single evaluation per bottleneck flow
+        ICoCCTranslator::CoCCLinearization linSum = linearizeFlows(bottleneckFlows, qmTarget);
 
+        do {
             // detect if m is too small and shift y to move away from plateau
             if (linSum.m < NEWTON_EPSILON) {
                 EV_DEBUG << "newton iteration hit plateau at qmTarget=" << qmTarget << endl;
 
-                const double qmRate = linSum.m * qmTarget + linSum.b;
+                const double qmRate = linSum.m * qmTarget + linSum.b + fixedRate_sum;
 
                 if (qmRate > rate) {
                     qmTarget *= 0.75;
@@ -465,14 +465,20 @@ void OracleCCCoordinator::computeLink(Link * const l) {
 
                 EV_DEBUG << "continuing at qmTarget=" << qmTarget << endl;
 
+                linSum = linearizeFlows(bottleneckFlows, qmTarget);
+
                 continue;
             }
 
-            qmTarget = CoCCUDPTransport::coccComputeLinkTargetQM(rate, linSum.m, linSum.b, true);
+            // flows with their target QM assigned elsewhere can not increase their sending rate further
+            qmTarget = CoCCUDPTransport::coccComputeLinkTargetQM(rate, linSum.m, linSum.b + fixedRate_sum, true);
 
-            double realRateSum = 0;
+            linSum = linearizeFlows(bottleneckFlows, qmTarget);
 
-            for (auto f : l->flows) {
+            // convergence is checked with all flows sending at qmTarget
+            double realRateSum = linSum.m * qmTarget + linSum.b;
+
+            for (auto f : fixedFlows) {
                 realRateSum += f->transport->getRateForQM(f->transportHandle, qmTarget);
             }
 
@@ -490,6 +496,19 @@ void OracleCCCoordinator::computeLink(Link * const l) {
     }
 }
 
+ICoCCTranslator::CoCCLinearization OracleCCCoordinator::linearizeFlows(const std::vector<Flow*>& flows, const double qmTarget) {
+    ICoCCTranslator::CoCCLinearization linSum = { 0, 0 };
+
+    for (auto f : flows) {
+        const ICoCCTranslator::CoCCLinearization lin = f->transport->getLinearizationForQM(f->transportHandle, qmTarget);
+
+        linSum.m += lin.m;
+        linSum.b += lin.b;
+    }
+
+    return linSum;
+}
+
 void OracleCCCoordinator::recomputePath(Flow * const f, Link * const l, const bool inbound) {
     Link * currentLink = l;
     Router * r = inbound ? l->from : l->to;
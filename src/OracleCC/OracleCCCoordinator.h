@@ -115,6 +115,7 @@ class OracleCCCoordinator : public cSimpleModule {
   protected:
     void computeOracle();
     void computeLink(Link * const l);
+    ICoCCTranslator::CoCCLinearization linearizeFlows(const std::vector<Flow*>& flows, const double qmTarget);
     void recomputePath(Flow * const f, Link * const l, const bool inbound);
 
 
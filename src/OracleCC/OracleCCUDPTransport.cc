@@ -37,14 +37,13 @@ Define_Module(OracleCCUDPTransport);
 
 
 OracleCCUDPTransport::~OracleCCUDPTransport() {
-    for (auto handle : connectionVect) {
+    for (auto handle : connectionTable) {
         delete handle;
     }
 
-    // no need to delete listenSocket, since it is also stored in connectionVect
+    // no need to delete listenSocket, since it is also stored in connectionTable
 
-    connectionMap.clear();
-    connectionVect.clear();
+    connectionTable.clear();
 }
 
 
@@ -140,26 +139,35 @@ void OracleCCUDPTransport::handleMessage(cMessage * const msg) {
     } else if (msg->arrivedOn(upIn->getId())) {
         cObject * const ctrlInfo = msg->getControlInfo();
 
-        if (dynamic_cast<TransportConnectReq *>(ctrlInfo)) {
-            TransportConnectReq * const req = dynamic_cast<TransportConnectReq *>(ctrlInfo);
+        switch (getTransportCtrlKind(ctrlInfo)) {
+        case TRANSPORT_CTRL_CONNECT_REQ: {
+            ASSERT(dynamic_cast<TransportConnectReq *>(ctrlInfo));
+
+            TransportConnectReq * const req = static_cast<TransportConnectReq *>(ctrlInfo);
 
             ASSERT(req);
 
             processConnectRequest(req);
 
             delete msg;
-        } else if (dynamic_cast<TransportListenReq *>(ctrlInfo)) {
-            const uint16_t listenPort = dynamic_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
+
+            break;
+        }
+        case TRANSPORT_CTRL_LISTEN_REQ: {
+            ASSERT(dynamic_cast<TransportListenReq *>(ctrlInfo));
+
+            const uint16_t listenPort = static_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
 
             delete msg;
 
             processListenRequest(listenPort);
-        } else if (dynamic_cast<TransportSetTranslator *>(ctrlInfo)) {
-            TransportSetTranslator * const req = dynamic_cast<TransportSetTranslator *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportSetTranslator control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_SET_TRANSLATOR: {
+            ASSERT(dynamic_cast<TransportSetTranslator *>(ctrlInfo));
+
+            TransportSetTranslator * const req = static_cast<TransportSetTranslator *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -172,12 +180,13 @@ void OracleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportStreamStartInfo *>(ctrlInfo)) {
-            TransportStreamStartInfo * const req = dynamic_cast<TransportStreamStartInfo *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportStreamStartInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_STREAM_START: {
+            ASSERT(dynamic_cast<TransportStreamStartInfo *>(ctrlInfo));
+
+            TransportStreamStartInfo * const req = static_cast<TransportStreamStartInfo *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -188,12 +197,13 @@ void OracleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportStreamStopInfo *>(ctrlInfo)) {
-            TransportStreamStopInfo * const req = dynamic_cast<TransportStreamStopInfo *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportStreamStopInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_STREAM_STOP: {
+            ASSERT(dynamic_cast<TransportStreamStopInfo *>(ctrlInfo));
+
+            TransportStreamStopInfo * const req = static_cast<TransportStreamStopInfo *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -204,15 +214,17 @@ void OracleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-        } else if (dynamic_cast<TransportDataInfo *>(ctrlInfo)) {
-            TransportDataInfo * const req = dynamic_cast<TransportDataInfo *>(msg->removeControlInfo());
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportDataInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_DATA: {
+            ASSERT(dynamic_cast<TransportDataInfo *>(ctrlInfo));
+
+            TransportDataInfo * const req = static_cast<TransportDataInfo *>(msg->removeControlInfo());
+
             ASSERT(dynamic_cast<RawPacket *>(msg));
 
-            RawPacket * const pkt = dynamic_cast<RawPacket *>(msg);
+            RawPacket * const pkt = static_cast<RawPacket *>(msg);
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
             if (handle) {
@@ -240,7 +252,10 @@ void OracleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete req;
-        } else {
+
+            break;
+        }
+        default:
             const char * const name = msg->getName();
 
             delete msg;
@@ -336,7 +351,7 @@ void OracleCCUDPTransport::handleIncomingHandshake(UDPHandshake * const hs,
 
     } else {
         // client side part, set port and flag connection as established
-        handle->port = ctrl->getSrcPort();
+        connectionTable.updatePort(handle, ctrl->getSrcPort());
         handle->connected = true;
 
         delete hs;
@@ -612,12 +627,10 @@ void OracleCCUDPTransport::connectSocket(SocketHandle_t * const handle, const L3
 void OracleCCUDPTransport::storeSocket(SocketHandle_t * const handle) {
     ASSERT(handle);
 
-    // may fail for incoming connections tied to the listen socket
-    // thats ok, we use the map in first place to retrieve the listen socket or
-    // to check if a socket context has been established. thus no assert here
-    connectionMap.insert(SocketMap_t::value_type(handle->socket->getSocketId(), handle));
-
-    connectionVect.insert(connectionVect.end(), handle);
+    // the ID of incoming connections tied to the listen socket stays associated
+    // with the listen socket. thats ok, we use the ID in first place to retrieve
+    // the listen socket or to check if a socket context has been established
+    connectionTable.insert(handle->socket->getSocketId(), handle);
 }
 
 void OracleCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * const selfMsg) {
@@ -668,14 +681,9 @@ void OracleCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage
  * connections, or the socket associated with an outgoing connection.
  */
 OracleCCUDPTransport::SocketHandle_t * OracleCCUDPTransport::getSocketById(const int id) {
-    const auto it = connectionMap.find(id);
+    SocketHandle_t * const handle = connectionTable.findById(id);
 
-    if (it == connectionMap.end()) {
-        return nullptr;
-    }
-
-    SocketHandle_t * const handle = it->second;
-    ASSERT(it->first == handle->socket->getSocketId());
+    ASSERT(!handle || id == handle->socket->getSocketId());
 
     return handle;
 }
@@ -689,17 +697,5 @@ OracleCCUDPTransport::SocketHandle_t * OracleCCUDPTransport::getSocketById(const
  * requiring the server to know the dst port of the client.
  */
 OracleCCUDPTransport::SocketHandle_t * OracleCCUDPTransport::getSocketByAddr(const L3Address& addr, const uint16_t port) {
-    SocketHandle_t * handle = nullptr;
-
-    for (auto it = connectionVect.begin(); it != connectionVect.end(); it++) {
-        if ((*it)->remote == addr) {
-            handle = *it; // address match, but a perfect one might be possible
-
-            if (handle->port == port) {
-                break; // perfect match, do not continue
-            }
-        }
-    }
-
-    return handle;
+    return connectionTable.findByAddr(addr, port);
 }
@@ -28,6 +28,7 @@
 
 #include "util/UDPHandshakePkt_m.h"
 #include "util/TransportCtrlMsg.h"
+#include "util/SocketTable.h"
 
 using namespace omnetpp;
 using namespace inet;
@@ -62,8 +63,7 @@ class OracleCCUDPTransport : public cSimpleModule, public ICoCCTranslator::ICont
 
         ~SocketHandle_t();
     };
-    typedef std::map<int, SocketHandle_t *> SocketMap_t;
-    typedef std::vector<SocketHandle_t *> SocketVector_t;
+    typedef SocketTable<SocketHandle_t> SocketTable_t;
 
     // variables
     cGate *udpIn;
@@ -74,8 +74,7 @@ class OracleCCUDPTransport : public cSimpleModule, public ICoCCTranslator::ICont
     simsignal_t expectedRate;
     simsignal_t appliedQM;
 
-    SocketMap_t connectionMap; // ConnId --> SocketHandle_t;
-    SocketVector_t connectionVect;
+    SocketTable_t connectionTable; // ConnId, remote address --> SocketHandle_t
     SocketHandle_t * listenSocket = nullptr;
 
     int lowerLayerOverhead;
@@ -39,14 +39,13 @@ simpleCCUDPTransport::simpleCCUDPTransport() {
 }
 
 simpleCCUDPTransport::~simpleCCUDPTransport() {
-    for (auto handle : connectionVect) {
+    for (auto handle : connectionTable) {
         delete handle;
     }
 
-    // no need to delete listenSocket, since it is also stored in connectionVect
+    // no need to delete listenSocket, since it is also stored in connectionTable
 
-    connectionMap.clear();
-    connectionVect.clear();
+    connectionTable.clear();
 }
 
 simpleCCUDPTransport::SocketHandle_t::~SocketHandle_t() {
@@ -160,27 +159,36 @@ void simpleCCUDPTransport::handleMessage(cMessage * const msg) {
         }
         } else if (msg->arrivedOn(upIn->getId())) {
         cObject * const ctrlInfo = msg->getControlInfo();
-        if (dynamic_cast<TransportConnectReq *>(ctrlInfo)) {
-            TransportConnectReq * const req = dynamic_cast<TransportConnectReq *>(ctrlInfo);
+
+        switch (getTransportCtrlKind(ctrlInfo)) {
+        case TRANSPORT_CTRL_CONNECT_REQ: {
+            ASSERT(dynamic_cast<TransportConnectReq *>(ctrlInfo));
+
+            TransportConnectReq * const req = static_cast<TransportConnectReq *>(ctrlInfo);
 
             ASSERT(req);
 
             processConnectRequest(req);
 
             delete msg;
-            } else if (dynamic_cast<TransportListenReq *>(ctrlInfo)) {
 
-            const uint16_t listenPort = dynamic_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
+            break;
+        }
+        case TRANSPORT_CTRL_LISTEN_REQ: {
+            ASSERT(dynamic_cast<TransportListenReq *>(ctrlInfo));
+
+            const uint16_t listenPort = static_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
 
             delete msg;
 
             processListenRequest(listenPort);
-            } else if (dynamic_cast<TransportSetTranslator *>(ctrlInfo)) {
-            TransportSetTranslator * const req = dynamic_cast<TransportSetTranslator *>(ctrlInfo);
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportSetTranslator control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_SET_TRANSLATOR: {
+            ASSERT(dynamic_cast<TransportSetTranslator *>(ctrlInfo));
+
+            TransportSetTranslator * const req = static_cast<TransportSetTranslator *>(ctrlInfo);
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
@@ -192,20 +200,24 @@ void simpleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete msg;
-            } else if (dynamic_cast<TransportStreamStartInfo *>(ctrlInfo)) {
 
+            break;
+        }
+        case TRANSPORT_CTRL_STREAM_START: {
             // unused
 
             delete msg;
-            } else if (dynamic_cast<TransportDataInfo *>(ctrlInfo)) {
-            TransportDataInfo * const req = dynamic_cast<TransportDataInfo *>(msg->removeControlInfo());
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportDataInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_DATA: {
+            ASSERT(dynamic_cast<TransportDataInfo *>(ctrlInfo));
+
+            TransportDataInfo * const req = static_cast<TransportDataInfo *>(msg->removeControlInfo());
+
             ASSERT(dynamic_cast<RawPacket *>(msg));
 
-            RawPacket * const pkt = dynamic_cast<RawPacket *>(msg);
+            RawPacket * const pkt = static_cast<RawPacket *>(msg);
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
 
             if (handle) {
@@ -234,7 +246,10 @@ void simpleCCUDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete req;
-        } else {
+
+            break;
+        }
+        default:
             const char * const name = msg->getName();
 
             delete msg;
@@ -301,7 +316,7 @@ void simpleCCUDPTransport::handleIncomingHandshake(UDPHandshake * const hs,
         txHandle->socket->sendTo(hs, txHandle->remote, txHandle->port);
     } else {
         // client side part, set port and flag connection as established
-        handle->port = ctrl->getSrcPort();
+        connectionTable.updatePort(handle, ctrl->getSrcPort());
         handle->connected = true;
 
         delete hs;
@@ -769,12 +784,10 @@ void simpleCCUDPTransport::connectSocket(SocketHandle_t * const handle, const L3
 void simpleCCUDPTransport::storeSocket(SocketHandle_t * const handle) {
     ASSERT(handle);
 
-    // may fail for incoming connections tied to the listen socket
-    // thats ok, we use the map in first place to retrieve the listen socket or
-    // to check if a socket context has been established. thus no assert here
-    connectionMap.insert(SocketMap_t::value_type(handle->socket->getSocketId(), handle));
-
-    connectionVect.insert(connectionVect.end(), handle);
+    // the ID of incoming connections tied to the listen socket stays associated
+    // with the listen socket. thats ok, we use the ID in first place to retrieve
+    // the listen socket or to check if a socket context has been established
+    connectionTable.insert(handle->socket->getSocketId(), handle);
 }
 
 void simpleCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * const selfMsg) {
@@ -793,15 +806,14 @@ void simpleCCUDPTransport::initHandshake(SocketHandle_t * const handle, cMessage
  * connections, or the socket associated with an outgoing connection.
  */
 simpleCCUDPTransport::SocketHandle_t * simpleCCUDPTransport::getSocketById(const int id) {
-    const auto it = connectionMap.find(id);
+    SocketHandle_t * const handle = connectionTable.findById(id);
 
-    if (it == connectionMap.end()) {
+    if (handle == nullptr) {
         EV_DEBUG << "getSocketById id not valid :  " << endl;
         return nullptr;
     }
 
-    SocketHandle_t * const handle = it->second;
-    ASSERT(it->first == handle->socket->getSocketId());
+    ASSERT(id == handle->socket->getSocketId());
 
     return handle;
 }
@@ -815,19 +827,5 @@ simpleCCUDPTransport::SocketHandle_t * simpleCCUDPTransport::getSocketById(const
  * requiring the server to know the dst port of the client.
  */
 simpleCCUDPTransport::SocketHandle_t * simpleCCUDPTransport::getSocketByAddr(const L3Address& addr, const uint16_t port) {
-    SocketHandle_t * handle = nullptr;
-
-    for (auto it = connectionVect.begin(); it != connectionVect.end(); it++) {
-        if ((*it)->remote == addr) {
-            handle = *it; // address match, but a perfect one might be possible
-
-            if (handle->port == port) {
-
-
-                break; // perfect match, do not continue
-            }
-        }
-    }
-
-    return handle;
+    return connectionTable.findByAddr(addr, port);
 }
@@ -27,6 +27,7 @@
 #include "simpleCCSerumHeader_m.h"
 #include "util/UDPHandshakePkt_m.h"
 #include "util/TransportCtrlMsg.h"
+#include "util/SocketTable.h"
 
 using namespace omnetpp;
 using namespace inet;
@@ -72,8 +73,7 @@ class simpleCCUDPTransport : public cSimpleModule {
 
         ~SocketHandle_t();
     };
-    typedef std::map<int, SocketHandle_t *> SocketMap_t;
-    typedef std::vector<SocketHandle_t *> SocketVector_t;
+    typedef SocketTable<SocketHandle_t> SocketTable_t;
 
     // variables
     cGate *udpIn;
@@ -83,8 +83,7 @@ class simpleCCUDPTransport : public cSimpleModule {
 
     simsignal_t expectedRate;
 
-    SocketMap_t connectionMap; // ConnId --> SocketHandle_t;
-    SocketVector_t connectionVect;
+    SocketTable_t connectionTable; // ConnId, remote address --> SocketHandle_t
     SocketHandle_t * listenSocket = nullptr;
 
     bool forceMonitoringReply;
@@ -15,6 +15,8 @@
 
 #include <util/FunctionTools.h>
 
+#include <algorithm>
+
 FunctionTools::Clamp FunctionTools::Clamp::UNBOUNDED = FunctionTools::Clamp(DBL_MIN, DBL_MAX);
 
 FunctionTools::Clamp::Clamp(const double min, const double max)
@@ -45,6 +47,12 @@ FunctionTools::Derivative::Derivative(const UnaryFunction &f, const double h)
 }
 
 double FunctionTools::Derivative::eval(const double x) const {
+    double y, dy;
+
+    if (f.evalWithDerivative(x, y, dy)) {
+        return dy;
+    }
+
     const double x_ = limit(x);
 
     const double deltaPh = limit(x_ + h) - x_;
@@ -58,6 +66,143 @@ double FunctionTools::Derivative::eval(const double x) const {
 }
 
 
+FunctionTools::TabulatedFunction::TabulatedFunction(const Clamp limit)
+        : FunctionTools::UnaryFunction(limit) {
+}
+
+void FunctionTools::TabulatedFunction::build(const UnaryFunction &f, const unsigned int intervals) {
+    ASSERT(intervals > 0);
+
+    step = (limit.max - limit.min) / intervals;
+
+    values.resize(intervals + 1);
+    coefficients.resize(4 * intervals);
+
+    for (unsigned int i = 0; i < intervals; i++) {
+        values[i] = f(limit.min + i * step);
+    }
+    values[intervals] = f(limit.max);
+
+    // slopes (scaled to the interval length) at the sampling points,
+    // limited such that monotonicity is preserved (Fritsch-Carlson)
+    std::vector<double> slopes(intervals + 1);
+
+    slopes[0] = values[1] - values[0];
+    slopes[intervals] = values[intervals] - values[intervals - 1];
+
+    for (unsigned int i = 1; i < intervals; i++) {
+        const double d0 = values[i] - values[i - 1];
+        const double d1 = values[i + 1] - values[i];
+
+        slopes[i] = (d0 * d1 > 0) ? (d0 + d1) / 2 : 0;
+    }
+
+    for (unsigned int i = 0; i < intervals; i++) {
+        const double delta = values[i + 1] - values[i];
+
+        if (delta == 0) {
+            slopes[i] = 0;
+            slopes[i + 1] = 0;
+        } else {
+            const double a = slopes[i] / delta;
+            const double b = slopes[i + 1] / delta;
+
+            if (a * a + b * b > 9) {
+                const double tau = 3 / std::sqrt(a * a + b * b);
+
+                slopes[i] = tau * a * delta;
+                slopes[i + 1] = tau * b * delta;
+            }
+        }
+    }
+
+    // cubic Hermite polynomial of each interval
+    for (unsigned int i = 0; i < intervals; i++) {
+        double * const c = &coefficients[4 * i];
+        const double delta = values[i + 1] - values[i];
+
+        c[0] = values[i];
+        c[1] = slopes[i];
+        c[2] = 3 * delta - 2 * slopes[i] - slopes[i + 1];
+        c[3] = -2 * delta + slopes[i] + slopes[i + 1];
+    }
+}
+
+double FunctionTools::TabulatedFunction::eval(const double x) const {
+    double t;
+    const double * const c = &coefficients[4 * locate(x, t)];
+
+    return ((c[3] * t + c[2]) * t + c[1]) * t + c[0];
+}
+
+double FunctionTools::TabulatedFunction::derivative(const double x) const {
+    double t;
+    const double * const c = &coefficients[4 * locate(x, t)];
+
+    return ((3 * c[3] * t + 2 * c[2]) * t + c[1]) / step;
+}
+
+double FunctionTools::TabulatedFunction::inverse(const double y) const {
+    ASSERT(!empty());
+
+    // catch cases where y is outside the range of the function
+    if (y <= values.front()) {
+        return limit.min;
+    }
+    if (y >= values.back()) {
+        return limit.max;
+    }
+
+    // first interval reaching y, values[i] < y <= values[i+1] holds
+    const unsigned int i = std::lower_bound(values.begin() + 1, values.end(), y) - values.begin() - 1;
+    const double * const c = &coefficients[4 * i];
+
+    // Newton's method on the interval polynomial, safeguarded by bisection
+    double lower = 0;
+    double upper = 1;
+    double t = (y - values[i]) / (values[i + 1] - values[i]);
+
+    for (unsigned int k = 0; k < 32; k++) {
+        const double deltaY = ((c[3] * t + c[2]) * t + c[1]) * t + c[0] - y;
+        const double slope = (3 * c[3] * t + 2 * c[2]) * t + c[1];
+
+        if (deltaY > 0) {
+            upper = t;
+        } else {
+            lower = t;
+        }
+
+        double next = (slope > 0) ? t - deltaY / slope : lower - 1;
+
+        if (next <= lower || next >= upper) {
+            next = lower + (upper - lower) / 2;
+        }
+
+        const bool converged = std::abs(next - t) < 1E-12;
+
+        t = next;
+
+        if (converged) {
+            break;
+        }
+    }
+
+    return limit(limit.min + (i + t) * step);
+}
+
+unsigned int FunctionTools::TabulatedFunction::locate(const double x, double &t) const {
+    ASSERT(!empty());
+
+    const unsigned int intervals = values.size() - 1;
+    const double u = (limit(x) - limit.min) / step;
+    const unsigned int i = std::min(static_cast<unsigned int>(u), intervals - 1);
+
+    t = u - i;
+
+    return i;
+}
+
+
 FunctionTools::BisectSolve::BisectSolve(const UnaryFunction &f, const FunctionTools::Clamp limit, const unsigned int iterations, const double eps)
         : f(f), limit(limit), iterations(iterations), eps(eps) {
 }
@@ -119,25 +264,31 @@ double FunctionTools::NewtonSolve::solve(const double y, const double x_start) c
         return 1;
     }
 
+    // value and slope at the current x, reused for the next step
+    double fx, f1;
+
+    evalWithDerivative(x, fx, f1);
+
     // approximate using Newton's method
     do {
-        const double f1 = derive(x);
-
         // detect if m is too small and shift y to move away from plateau
         if (f1 < eps) {
             EV_DEBUG << "NewtonSolve(" << x_start << ", " << y << ") hit plateau at x=" << x << std::endl;
 
             x = bisect.solve(y, x);
+            evalWithDerivative(x, fx, f1);
 
             EV_DEBUG << "continuing after bisection at x=" << x << std::endl;
 
             continue;
         }
 
-        x = x - (f(x) - y) / f1;
+        x = x - (fx - y) / f1;
         x = limit(x); // keep argument within range
 
-        if (std::abs(f(x) - y) < eps) {
+        evalWithDerivative(x, fx, f1);
+
+        if (std::abs(fx - y) < eps) {
             EV_DEBUG << "NewtonSolve(" << x_start << ", " << y << ") converged within " << i << " iterations." << std::endl;
 
             break;
@@ -150,3 +301,11 @@ double FunctionTools::NewtonSolve::solve(const double y, const double x_start) c
 
     return limit(x);
 }
+
+void FunctionTools::NewtonSolve::evalWithDerivative(const double x, double &y, double &dy) const {
+    // fall back to finite differences if f has no analytic derivative
+    if (!f.evalWithDerivative(x, y, dy)) {
+        y = f(x);
+        dy = derive(x);
+    }
+}
@@ -17,6 +17,7 @@
 #define UTIL_FUNCTIONTOOLS_H_
 
 #include <omnetpp.h>
+#include <vector>
 
 #define CLAMP(clamp_x, clamp_min, clamp_max) std::min(std::max((clamp_x), (clamp_min)), (clamp_max))
 
@@ -39,16 +40,39 @@ namespace FunctionTools {
     bool operator!=(const Clamp &lhs, const Clamp &rhs);
 
 
+    /**
+     * Dual number for forward-mode automatic differentiation, i.e. evaluating
+     * a function template with Dual(x, 1) yields f(x) and f'(x).
+     */
+    struct Dual {
+        Dual(const double value = 0, const double slope = 0) : value(value), slope(slope) { };
+
+        double value;
+        double slope;
+    };
+    inline Dual operator+(const Dual &a, const Dual &b) { return Dual(a.value + b.value, a.slope + b.slope); };
+    inline Dual operator-(const Dual &a, const Dual &b) { return Dual(a.value - b.value, a.slope - b.slope); };
+    inline Dual operator-(const Dual &a) { return Dual(-a.value, -a.slope); };
+    inline Dual operator*(const Dual &a, const Dual &b) { return Dual(a.value * b.value, a.slope * b.value + a.value * b.slope); };
+    inline Dual operator/(const Dual &a, const Dual &b) { return Dual(a.value / b.value, (a.slope * b.value - a.value * b.slope) / (b.value * b.value)); };
+    inline Dual sqrt(const Dual &a) { const double root = std::sqrt(a.value); return Dual(root, a.slope / (2 * root)); };
+    inline double valueOf(const double x) { return x; };
+    inline double valueOf(const Dual &x) { return x.value; };
+
+
     class UnaryFunction {
     public:
         UnaryFunction(const Clamp limit = Clamp::UNBOUNDED);
         virtual ~UnaryFunction() { };
         double operator()(const double x) const { return eval(limit(x)); };
+        // f(x) and f'(x) in one evaluation, false if f provides no analytic derivative
+        bool evalWithDerivative(const double x, double &y, double &dy) const { return evalWithDerivativeImpl(limit(x), y, dy); };
 
         const Clamp limit;
 
     protected:
         virtual double eval(const double x) const { return x; };
+        virtual bool evalWithDerivativeImpl(const double, double &, double &) const { return false; }
     };
 
 
@@ -74,6 +98,29 @@ namespace FunctionTools {
     };
 
 
+    /**
+     * Monotonicity preserving piecewise cubic interpolation (Fritsch-Carlson)
+     * of a function, sampled at equidistant points within the limits.
+     * Evaluation, derivative and inverse only read the table.
+     */
+    class TabulatedFunction : public UnaryFunction {
+    public:
+        TabulatedFunction(const Clamp limit);
+        void build(const UnaryFunction &f, const unsigned int intervals);
+        bool empty() const { return values.empty(); };
+        double derivative(const double x) const;
+        double inverse(const double y) const; // smallest x with f(x) == y for monotone increasing functions
+
+    protected:
+        double eval(const double x) const override;
+        unsigned int locate(const double x, double &t) const;
+
+        std::vector<double> values; // function values at the sampling points
+        std::vector<double> coefficients; // 4 polynomial coefficients in t=[0,1] per interval
+        double step = 0;
+    };
+
+
     class BisectSolve : public BinaryFunction {
     public:
         BisectSolve(const UnaryFunction &f, const Clamp limit = Clamp::UNBOUNDED, const unsigned int iterations = 128, const double eps = 1E-8);
@@ -104,6 +151,7 @@ namespace FunctionTools {
 
     protected:
         double eval(const double x, const double y) const override { return solve(y, x); };
+        void evalWithDerivative(const double x, double &y, double &dy) const;
     };
 
 };
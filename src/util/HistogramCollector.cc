@@ -25,18 +25,27 @@ HistogramCollector::~HistogramCollector() {
 
 
 void HistogramCollector::sent(const uint64_t id, const simtime_t timestamp, const bool lost) {
-    samples.push_back({id, timestamp, SIMTIME_ZERO, lost});
+    const uint64_t seq = frontSeq + samples.size();
+
+    samples.push_back({id, timestamp, SIMTIME_ZERO, lost, NO_SAMPLE});
+    indexSample(seq);
+    accountSample(seq, 1);
     pktSent++;
 }
 
 simtime_t HistogramCollector::received(const uint64_t id, const simtime_t timestamp) {
-    for (auto it = samples.begin(); it != samples.end(); it++) {
-        if (it->pktId == id) {
-            it->received = timestamp;
-            pktRcvd++;
+    const IdEntry * const entry = findId(id);
 
-            return it->received - it->sent;
-        }
+    if (entry) {
+        const uint64_t seq = entry->first;
+        Sample &sample = getSample(seq);
+
+        accountSample(seq, -1);
+        sample.received = timestamp;
+        accountSample(seq, 1);
+        pktRcvd++;
+
+        return sample.received - sample.sent;
     }
 
     EV_INFO << "Received NCS packet with id " << id << " outside of histogram collection window. "
@@ -46,12 +55,14 @@ simtime_t HistogramCollector::received(const uint64_t id, const simtime_t timest
 }
 
 void HistogramCollector::lost(const uint64_t id) {
-    for (auto it = samples.begin(); it != samples.end(); it++) {
-        if (it->pktId == id) {
-            it->lost = true;
+    const IdEntry * const entry = findId(id);
 
-            return;
-        }
+    if (entry) {
+        const uint64_t seq = entry->first;
+
+        accountSample(seq, -1);
+        getSample(seq).lost = true;
+        accountSample(seq, 1);
     }
 }
 
@@ -61,7 +72,10 @@ void HistogramCollector::prune(const simtime_t now, const simtime_t maxAge,
         // remove all samples until maxSamples is reached
         // then remove all additional outdated samples
         if ((count > maxSamples) || (now - samples.begin()->sent > maxAge)) {
+            accountSample(frontSeq, -1);
+            unindexSample(frontSeq);
             samples.pop_front();
+            frontSeq++;
         } else {
             break; // all other samples will have a newer timestamp
         }
@@ -81,20 +95,69 @@ std::vector<double> HistogramCollector::compute(const simtime_t now,
         return result;
     }
 
-    result.resize(bins, 0.0);
+    // bins are maintained incrementally, a full rebuild is only required
+    // if the binning changed, e.g. due to a new control period
+    if (bins != binCount || period != binPeriod) {
+        rebuildBins(period, bins);
+    }
 
-    // might be implemented incremental, but the overhead should be rather low
-    for (auto it = samples.begin(); it != samples.end(); it++) {
-        const simtime_t delay =
-                (it->received >= it->sent ? it->received : now) - it->sent;
-        const uint64_t bin = std::min((uint64_t) std::ceil(delay / period), (uint64_t) bins - 1);
+    result.assign(resolvedBins.begin(), resolvedBins.end());
 
-        if (it->received >= it->sent) {
-            // delay is known, write data into bin
-            result[bin] += 1;
-        } else if (!it->lost && !presumeLoss) {
+    if (presumeLoss) {
+        // we do know nothing and presume loss
+        result[bins - 1] += pendingSamples.size();
+    } else {
+        for (const uint64_t seq : pendingSamples) {
             // delay is unknown, might be somewhere in bin..bins-1
             // assume equal distribution
+            const uint bin = getBin(now - getSample(seq).sent, period, bins);
+
+            for (uint i = bin; i < bins; i++) {
+                result[i] += 1.0 / (bins - bin);
+            }
+        }
+    }
+
+    for (uint i = 0; i < bins; i++) {
+        result[i] = result[i] / samples.size();
+    }
+
+    return result;
+}
+
+uint HistogramCollector::computeWindow(std::vector<double>& result, const simtime_t now,
+        const simtime_t maxAge, const uint minSamples, const uint maxSamples,
+        const simtime_t period, const uint bins, const bool presumeLoss) const {
+    ASSERT(bins > 0);
+
+    // skip all samples which would be removed by prune()
+    auto begin = samples.begin();
+
+    for (uint count = samples.size(); count > minSamples; count--, begin++) {
+        if ((count <= maxSamples) && (now - begin->sent <= maxAge)) {
+            break; // all other samples will have a newer timestamp
+        }
+    }
+
+    const uint count = samples.end() - begin;
+
+    // no data within the window, assume equal distribution
+    if (count == 0) {
+        result.assign(bins, 1.0 / bins);
+
+        return 0;
+    }
+
+    result.assign(bins, 0.0);
+
+    // the window is expected to be short, thus it is simply scanned
+    for (auto it = begin; it != samples.end(); it++) {
+        if (hasKnownDelay(*it)) {
+            result[getBin(it->received - it->sent, period, bins)] += 1;
+        } else if (!it->lost && !presumeLoss) {
+            // delay is unknown, might be somewhere in bin..bins-1
+            const uint bin = getBin(now - it->sent, period, bins);
+
             for (uint i = bin; i < bins; i++) {
                 result[i] += 1.0 / (bins - bin);
             }
@@ -105,10 +168,10 @@ std::vector<double> HistogramCollector::compute(const simtime_t now,
     }
 
     for (uint i = 0; i < bins; i++) {
-        result[i] = result[i] / samples.size();
+        result[i] = result[i] / count;
     }
 
-    return result;
+    return count;
 }
 
 uint HistogramCollector::sampleCount() const {
@@ -116,14 +179,9 @@ uint HistogramCollector::sampleCount() const {
 }
 
 void HistogramCollector::resetStats() {
+    statsStart = simTime();
     pktSent = 0;
-    pktRcvd = 0;
-
-    for (auto it = samples.begin(); it != samples.end(); it++) {
-        if (it->received == SIMTIME_ZERO) {
-            pktRcvd--; // reduce by amount of in-flight pkts
-        }
-    }
+    pktRcvd = -pktNotRcvd; // reduce by amount of in-flight pkts
 }
 
 long HistogramCollector::pktsSent() const {
@@ -134,15 +192,176 @@ long HistogramCollector::pktsArrived() const {
     return pktRcvd;
 }
 
-long HistogramCollector::pktsLost() const {
-    long pktInFlight = 0;
+void HistogramCollector::writeSnapshot(SnapshotWriter& snapshot) const {
+    snapshot.value("pktSent", pktSent);
+    snapshot.value("pktRcvd", pktRcvd);
+    snapshot.value("statsStart", statsStart);
+    snapshot.value("sampleCount", samples.size());
 
     for (auto it = samples.begin(); it != samples.end(); it++) {
-        if (!it->lost && it->received == SIMTIME_ZERO) {
-            pktInFlight++;
+        snapshot.value("sample", it->pktId, it->sent, it->received, it->lost);
+    }
+}
+
+void HistogramCollector::readSnapshot(SnapshotReader& snapshot) {
+    size_t count;
+
+    snapshot.value("pktSent", pktSent);
+    snapshot.value("pktRcvd", pktRcvd);
+    snapshot.value("statsStart", statsStart);
+    snapshot.value("sampleCount", count);
+
+    samples.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        Sample sample = {};
+
+        snapshot.value("sample", sample.pktId, sample.sent, sample.received, sample.lost);
+
+        // the network state is not part of the snapshot, in-flight packets will never arrive
+        if (!isInFlight(sample)) {
+            samples.push_back(sample);
+        } else if (sample.sent >= statsStart) {
+            pktSent--;
+        } else {
+            pktRcvd++; // undo the adjustment of resetStats() for this packet
         }
     }
 
+    rebuildIndex();
+}
+
+long HistogramCollector::pktsLost() const {
     return pktSent - pktRcvd - pktInFlight;
 }
 
+HistogramCollector::IdEntry* HistogramCollector::findId(const uint64_t id) {
+    if (id >= idRingBase && id - idRingBase < idRing.size()) {
+        IdEntry &entry = idRing[id - idRingBase];
+
+        if (entry.first != NO_SAMPLE) {
+            return &entry;
+        }
+    }
+
+    // ids may have been hashed before the ring grew beyond them
+    const auto it = idHash.find(id);
+
+    return (it != idHash.end()) ? &it->second : nullptr;
+}
+
+void HistogramCollector::indexSample(const uint64_t seq) {
+    Sample &sample = getSample(seq);
+    const uint64_t id = sample.pktId;
+    IdEntry * const entry = findId(id);
+
+    sample.nextSameId = NO_SAMPLE;
+
+    if (entry) {
+        // chain samples with the same id, lookups always return the oldest one
+        getSample(entry->last).nextSameId = seq;
+        entry->last = seq;
+
+        return;
+    }
+
+    if (idRing.empty()) {
+        idRingBase = id;
+    }
+
+    if (id >= idRingBase && id - idRingBase < idRing.size() + MAX_ID_GAP) {
+        const uint64_t offset = id - idRingBase;
+
+        if (offset >= idRing.size()) {
+            idRing.resize(offset + 1, {NO_SAMPLE, NO_SAMPLE});
+        }
+
+        idRing[offset] = {seq, seq};
+    } else {
+        idHash[id] = {seq, seq};
+    }
+}
+
+void HistogramCollector::unindexSample(const uint64_t seq) {
+    const Sample &sample = getSample(seq);
+    const uint64_t id = sample.pktId;
+    IdEntry * const entry = findId(id);
+
+    // samples are removed in order, thus always the oldest one of its id
+    ASSERT(entry && entry->first == seq);
+
+    if (entry->last != seq) {
+        entry->first = sample.nextSameId;
+
+        return;
+    }
+
+    if (id >= idRingBase && id - idRingBase < idRing.size() && entry == &idRing[id - idRingBase]) {
+        entry->first = NO_SAMPLE;
+
+        while (!idRing.empty() && idRing.front().first == NO_SAMPLE) {
+            idRing.pop_front();
+            idRingBase++;
+        }
+    } else {
+        idHash.erase(id);
+    }
+}
+
+void HistogramCollector::rebuildIndex() {
+    idRing.clear();
+    idHash.clear();
+    pktInFlight = 0;
+    pktNotRcvd = 0;
+    binCount = 0; // rebuilt on next compute()
+    pendingSamples.clear();
+
+    for (uint64_t seq = frontSeq; seq < frontSeq + samples.size(); seq++) {
+        indexSample(seq);
+        accountSample(seq, 1);
+    }
+}
+
+void HistogramCollector::accountSample(const uint64_t seq, const long weight) {
+    const Sample &sample = getSample(seq);
+
+    if (isInFlight(sample)) {
+        pktInFlight += weight;
+    }
+
+    if (sample.received == SIMTIME_ZERO) {
+        pktNotRcvd += weight;
+    }
+
+    if (hasKnownDelay(sample)) {
+        if (binCount > 0) {
+            resolvedBins[getBin(sample.received - sample.sent, binPeriod, binCount)] += weight;
+        }
+    } else if (sample.lost) {
+        if (binCount > 0) {
+            resolvedBins[binCount - 1] += weight;
+        }
+    } else if (weight > 0) {
+        pendingSamples.insert(seq);
+    } else {
+        pendingSamples.erase(seq);
+    }
+}
+
+void HistogramCollector::rebuildBins(const simtime_t period, const uint bins) {
+    binPeriod = period;
+    binCount = bins;
+    resolvedBins.assign(bins, 0);
+
+    for (auto it = samples.begin(); it != samples.end(); it++) {
+        if (hasKnownDelay(*it)) {
+            resolvedBins[getBin(it->received - it->sent, period, bins)]++;
+        } else if (it->lost) {
+            resolvedBins[bins - 1]++;
+        }
+    }
+}
+
+uint HistogramCollector::getBin(const simtime_t delay, const simtime_t period, const uint bins) {
+    return std::min((uint64_t) std::ceil(delay / period), (uint64_t) bins - 1);
+}
@@ -18,6 +18,10 @@
 
 #include <omnetpp.h>
 #include <deque>
+#include <set>
+#include <unordered_map>
+
+#include "Snapshot.h"
 
 using namespace omnetpp;
 
@@ -34,6 +38,13 @@ public:
             const uint minSamples, const uint maxSamples);
     std::vector<double> compute(const simtime_t now, const simtime_t period,
             const uint bins, const bool presumeLoss = false);
+    // like compute(), but restricted to the samples which would remain after
+    // prune(now, maxAge, minSamples, maxSamples), without modifying the collector.
+    // The distribution is written into result, the number of samples within
+    // the window is returned.
+    uint computeWindow(std::vector<double>& result, const simtime_t now,
+            const simtime_t maxAge, const uint minSamples, const uint maxSamples,
+            const simtime_t period, const uint bins, const bool presumeLoss = false) const;
 
     uint sampleCount() const;
 
@@ -42,19 +53,70 @@ public:
     long pktsArrived() const;
     long pktsLost() const;
 
+    void writeSnapshot(SnapshotWriter& snapshot) const;
+    // samples of packets still in flight are dropped, as if they had never been sent
+    void readSnapshot(SnapshotReader& snapshot);
+
 protected:
+    static const uint64_t NO_SAMPLE = UINT64_MAX;
+    // maximum distance of a pktId beyond the newest one to be kept in idRing
+    static const uint64_t MAX_ID_GAP = 256;
+
     struct Sample {
         uint64_t pktId;
         simtime_t sent;
         simtime_t received;
         bool lost;
+        // sequence number of the next sample with the same pktId, NO_SAMPLE if none
+        uint64_t nextSameId;
+    };
+
+    // first and last sample (by sequence number) with a certain pktId
+    struct IdEntry {
+        uint64_t first;
+        uint64_t last;
     };
 
+    Sample& getSample(const uint64_t seq) { return samples[seq - frontSeq]; };
+    IdEntry* findId(const uint64_t id);
+    void indexSample(const uint64_t seq);
+    void unindexSample(const uint64_t seq);
+    void rebuildIndex();
+    // adds (weight 1) or removes (weight -1) the sample from the running counters and bins
+    void accountSample(const uint64_t seq, const long weight);
+    void rebuildBins(const simtime_t period, const uint bins);
+
+    static bool isInFlight(const Sample& sample) { return !sample.lost && sample.received == SIMTIME_ZERO; };
+    static bool hasKnownDelay(const Sample& sample) { return sample.received >= sample.sent; };
+    static uint getBin(const simtime_t delay, const simtime_t period, const uint bins);
+
     typedef std::deque<Sample> SampleDeque_t;
     SampleDeque_t samples;
+    // sequence number of samples.front(), sequence numbers increase with each sent sample
+    uint64_t frontSeq = 0;
+
+    // pktId index, mostly increasing ids are kept in a ring starting at
+    // idRingBase, all others in a hash map
+    std::deque<IdEntry> idRing;
+    uint64_t idRingBase = 0;
+    std::unordered_map<uint64_t, IdEntry> idHash;
 
     long pktSent = 0;
     long pktRcvd = 0;
+    // time of the last resetStats()
+    simtime_t statsStart = SIMTIME_ZERO;
+    // samples within the window, which are neither received nor lost
+    long pktInFlight = 0;
+    // samples within the window without received timestamp
+    long pktNotRcvd = 0;
+
+    // bins of samples with known delay or lost samples, maintained
+    // incrementally for the period and number of bins of the last compute()
+    simtime_t binPeriod;
+    uint binCount = 0;
+    std::vector<long> resolvedBins;
+    // samples with yet unknown delay, spread over the bins at query time
+    std::set<uint64_t> pendingSamples;
 };
 
 #endif /* UTIL_HISTOGRAMCOLLECTOR_H_ */
@@ -0,0 +1,104 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "LatencyHistogram.h"
+
+#include <chrono>
+
+LatencyHistogram::LatencyHistogram() {
+    buckets.fill(0);
+}
+
+LatencyHistogram::~LatencyHistogram() {
+}
+
+void LatencyHistogram::add(const uint64_t nanoseconds) {
+    buckets[bucketIndex(nanoseconds)]++;
+    samples++;
+
+    if (nanoseconds > maxValue) {
+        maxValue = nanoseconds;
+    }
+}
+
+void LatencyHistogram::reset() {
+    buckets.fill(0);
+    samples = 0;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return samples;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return maxValue;
+}
+
+uint64_t LatencyHistogram::quantile(const double q) const {
+    if (samples == 0) {
+        return 0;
+    }
+
+    // rank of the requested sample, starting at 1
+    const double scaledRank = q * samples;
+    uint64_t rank = (scaledRank <= 1) ? 1 : static_cast<uint64_t>(scaledRank + 0.5);
+
+    if (rank > samples) {
+        rank = samples;
+    }
+
+    uint64_t seen = 0;
+
+    for (unsigned int i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+
+        if (seen >= rank) {
+            const uint64_t bound = bucketUpperBound(i);
+
+            return (bound < maxValue) ? bound : maxValue;
+        }
+    }
+
+    return maxValue;
+}
+
+uint64_t LatencyHistogram::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned int LatencyHistogram::bucketIndex(const uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+
+    const unsigned int msb = 63 - __builtin_clzll(value);
+    const unsigned int shift = msb - SUB_BUCKET_BITS;
+
+    return ((shift + 1) << SUB_BUCKET_BITS) + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const unsigned int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    const unsigned int shift = (index >> SUB_BUCKET_BITS) - 1;
+    const uint64_t lower = static_cast<uint64_t>((index & (SUB_BUCKETS - 1)) | SUB_BUCKETS) << shift;
+
+    return lower + ((static_cast<uint64_t>(1) << shift) - 1);
+}
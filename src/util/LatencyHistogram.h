@@ -0,0 +1,59 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef UTIL_LATENCYHISTOGRAM_H_
+#define UTIL_LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <cstdint>
+
+/**
+ * Low-overhead histogram of wall-clock call durations (in nanoseconds).
+ *
+ * Buckets are spaced logarithmically: each power of two is split into
+ * 2^SUB_BUCKET_BITS linear sub-buckets, thus reported quantiles have a
+ * relative error below 2^-SUB_BUCKET_BITS. Adding a sample is a handful of
+ * integer operations without any allocation.
+ */
+class LatencyHistogram {
+
+public:
+    LatencyHistogram();
+    virtual ~LatencyHistogram();
+
+    void add(const uint64_t nanoseconds);
+    void reset();
+
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t quantile(const double q) const; // upper bound of the bucket containing the q-quantile
+
+    static uint64_t now(); // monotonic wall-clock time in nanoseconds
+
+protected:
+    static const unsigned int SUB_BUCKET_BITS = 3;
+    static const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const unsigned int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    static unsigned int bucketIndex(const uint64_t value);
+    static uint64_t bucketUpperBound(const unsigned int index);
+
+    std::array<uint64_t, BUCKET_COUNT> buckets;
+    uint64_t samples = 0;
+    uint64_t maxValue = 0;
+};
+
+#endif /* UTIL_LATENCYHISTOGRAM_H_ */
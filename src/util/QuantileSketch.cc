@@ -0,0 +1,177 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "QuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+constexpr double QuantileSketch::MIN_VALUE;
+
+QuantileSketch::QuantileSketch(const double relativeAccuracy, const unsigned int maxBins) :
+        accuracy(relativeAccuracy),
+        gamma((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+        logGamma(std::log(gamma)),
+        binLimit(maxBins) {
+    if (!(relativeAccuracy > 0 && relativeAccuracy < 1)) {
+        throw std::invalid_argument("QuantileSketch: relative accuracy must be within (0, 1)");
+    }
+
+    if (maxBins == 0) {
+        throw std::invalid_argument("QuantileSketch: at least one bin is required");
+    }
+}
+
+QuantileSketch::~QuantileSketch() {
+}
+
+void QuantileSketch::add(const double value) {
+    if (value < MIN_VALUE) {
+        zeroCount++;
+    } else {
+        increment(binIndex(value), 1);
+    }
+
+    if (total == 0 || value < minValue) {
+        minValue = value;
+    }
+
+    if (total == 0 || value > maxValue) {
+        maxValue = value;
+    }
+
+    total++;
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.gamma != gamma) {
+        throw std::invalid_argument("QuantileSketch: cannot merge sketches of different accuracy");
+    }
+
+    if (other.total == 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < other.bins.size(); i++) {
+        if (other.bins[i] > 0) {
+            increment(other.offset + i, other.bins[i]);
+        }
+    }
+
+    zeroCount += other.zeroCount;
+
+    minValue = (total == 0) ? other.minValue : std::min(minValue, other.minValue);
+    maxValue = (total == 0) ? other.maxValue : std::max(maxValue, other.maxValue);
+    total += other.total;
+}
+
+void QuantileSketch::reset() {
+    bins.clear();
+    offset = 0;
+    zeroCount = 0;
+    total = 0;
+    minValue = 0;
+    maxValue = 0;
+}
+
+uint64_t QuantileSketch::count() const {
+    return total;
+}
+
+double QuantileSketch::min() const {
+    return minValue;
+}
+
+double QuantileSketch::max() const {
+    return maxValue;
+}
+
+double QuantileSketch::quantile(const double q) const {
+    if (total == 0) {
+        return 0;
+    }
+
+    // (zero based) rank of the requested value
+    const double rank = std::min(std::max(q, 0.0), 1.0) * (total - 1);
+    uint64_t seen = zeroCount;
+    double value = maxValue;
+
+    if (seen > rank) {
+        value = 0;
+    } else {
+        for (unsigned int i = 0; i < bins.size(); i++) {
+            seen += bins[i];
+
+            if (seen > rank) {
+                value = binValue(offset + i);
+                break;
+            }
+        }
+    }
+
+    return std::min(std::max(value, minValue), maxValue);
+}
+
+double QuantileSketch::relativeAccuracy() const {
+    return accuracy;
+}
+
+unsigned int QuantileSketch::maxBins() const {
+    return binLimit;
+}
+
+int QuantileSketch::binIndex(const double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / logGamma));
+}
+
+double QuantileSketch::binValue(const int index) const {
+    // value with the same relative distance to both bin bounds
+    return 2 * std::pow(gamma, index) / (gamma + 1);
+}
+
+void QuantileSketch::increment(int index, const uint64_t n) {
+    if (bins.empty()) {
+        offset = index;
+        bins.push_back(0);
+    } else if (index < offset) {
+        // values below the range of maxBins are counted in the lowest bin
+        const int top = offset + static_cast<int>(bins.size()) - 1;
+
+        index = std::max(index, top - static_cast<int>(binLimit) + 1);
+
+        if (index < offset) {
+            bins.insert(bins.begin(), offset - index, 0);
+            offset = index;
+        }
+    } else if (index >= offset + static_cast<int>(bins.size())) {
+        // collapse the lowest bins which drop out of the range of maxBins
+        const int newOffset = std::max(offset, index - static_cast<int>(binLimit) + 1);
+        uint64_t collapsed = 0;
+
+        while (offset < newOffset && !bins.empty()) {
+            collapsed += bins.front();
+            bins.pop_front();
+            offset++;
+        }
+
+        offset = newOffset;
+        bins.resize(index - offset + 1, 0);
+        bins.front() += collapsed;
+    }
+
+    bins[index - offset] += n;
+}
@@ -0,0 +1,73 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef UTIL_QUANTILESKETCH_H_
+#define UTIL_QUANTILESKETCH_H_
+
+#include <cstdint>
+#include <deque>
+
+/**
+ * Mergeable streaming quantile sketch for non-negative values (DDSketch).
+ *
+ * Values are counted in logarithmically spaced bins, bin i covers
+ * (gamma^(i-1), gamma^i] with gamma = (1 + a) / (1 - a) for the relative
+ * accuracy a. Thus reported quantiles have a relative error of at most a.
+ * At most maxBins bins are kept, if the range of values exceeds them, the
+ * lowest bins are collapsed, i.e. only the accuracy of low quantiles suffers.
+ * Sketches with the same configuration can be merged without loss.
+ */
+class QuantileSketch {
+
+public:
+    QuantileSketch(const double relativeAccuracy = 0.01, const unsigned int maxBins = 2048);
+    virtual ~QuantileSketch();
+
+    void add(const double value);
+    void merge(const QuantileSketch& other);
+    void reset();
+
+    uint64_t count() const;
+    double min() const;
+    double max() const;
+    double quantile(const double q) const;
+
+    double relativeAccuracy() const;
+    unsigned int maxBins() const;
+
+protected:
+    // values below are counted as zero
+    static constexpr double MIN_VALUE = 1E-12;
+
+    int binIndex(const double value) const;
+    double binValue(const int index) const;
+    void increment(int index, const uint64_t n);
+
+    double accuracy;
+    double gamma;
+    double logGamma;
+    unsigned int binLimit;
+
+    // bins[i] counts the values of bin offset + i
+    std::deque<uint64_t> bins;
+    int offset = 0;
+    uint64_t zeroCount = 0;
+    uint64_t total = 0;
+    double minValue = 0;
+    double maxValue = 0;
+};
+
+#endif /* UTIL_QUANTILESKETCH_H_ */
@@ -0,0 +1,89 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "Snapshot.h"
+
+#include <cstdlib>
+
+SnapshotWriter::SnapshotWriter(std::ostream& out) : out(out) {
+}
+
+SnapshotWriter::~SnapshotWriter() {
+}
+
+void SnapshotWriter::section(const std::string& name) {
+    out << '[' << name << "]\n";
+}
+
+void SnapshotWriter::put(const double val) {
+    out << std::hexfloat << val << std::defaultfloat;
+}
+
+void SnapshotWriter::put(const SimTime& val) {
+    out << val.raw();
+}
+
+
+SnapshotReader::SnapshotReader(std::istream& in) : in(in) {
+}
+
+SnapshotReader::~SnapshotReader() {
+}
+
+void SnapshotReader::section(const std::string& name) {
+    nextLine(('[' + name + ']').c_str());
+}
+
+void SnapshotReader::nextLine(const char * const key) {
+    std::string text;
+
+    if (!std::getline(in, text)) {
+        throw cRuntimeError("Snapshot ended unexpectedly, expected key '%s'", key);
+    }
+
+    line.clear();
+    line.str(text);
+
+    if (!(line >> lineKey) || lineKey != key) {
+        throw cRuntimeError("Snapshot is inconsistent, expected key '%s' but found line '%s'", key, text.c_str());
+    }
+}
+
+std::string SnapshotReader::nextToken() {
+    std::string token;
+
+    if (!(line >> token)) {
+        throw cRuntimeError("Snapshot is inconsistent, missing value for key '%s'", lineKey.c_str());
+    }
+
+    return token;
+}
+
+void SnapshotReader::get(double& val) {
+    // operator>> does not reliably parse hex floats, strtod does
+    const std::string token = nextToken();
+    char * end = nullptr;
+
+    val = std::strtod(token.c_str(), &end);
+
+    if (*end != '\0') {
+        throw cRuntimeError("Snapshot is inconsistent, invalid value '%s' for key '%s'", token.c_str(), lineKey.c_str());
+    }
+}
+
+void SnapshotReader::get(SimTime& val) {
+    val.setRaw(std::stoll(nextToken()));
+}
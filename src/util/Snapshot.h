@@ -0,0 +1,147 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef UTIL_SNAPSHOT_H_
+#define UTIL_SNAPSHOT_H_
+
+#include <omnetpp.h>
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+using namespace omnetpp;
+
+/**
+ * Line-oriented text format for snapshots of the NCS state.
+ *
+ * Each line holds a key followed by one or more values. Doubles are written
+ * as hex floats and simtimes as raw integers, thus all values are restored
+ * bit-exact. The reader expects keys in exactly the order they were written
+ * and raises an error on any mismatch.
+ */
+class SnapshotWriter {
+
+public:
+    SnapshotWriter(std::ostream& out);
+    virtual ~SnapshotWriter();
+
+    void section(const std::string& name);
+
+    template<typename... T>
+    void value(const char * const key, const T&... values) {
+        out << key;
+        putAll(values...);
+        out << '\n';
+    }
+
+    template<typename C>
+    void values(const char * const key, const C& container) {
+        out << key << ' ' << container.size();
+
+        for (const auto& val : container) {
+            out << ' ';
+            put(val);
+        }
+
+        out << '\n';
+    }
+
+protected:
+    void putAll() { };
+
+    template<typename T, typename... R>
+    void putAll(const T& first, const R&... rest) {
+        out << ' ';
+        put(first);
+        putAll(rest...);
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type put(const T val) {
+        out << +val;
+    }
+
+    void put(const double val);
+    void put(const SimTime& val);
+
+    std::ostream& out;
+};
+
+class SnapshotReader {
+
+public:
+    SnapshotReader(std::istream& in);
+    virtual ~SnapshotReader();
+
+    void section(const std::string& name);
+
+    template<typename... T>
+    void value(const char * const key, T&... values) {
+        nextLine(key);
+        getAll(values...);
+    }
+
+    template<typename C>
+    void values(const char * const key, C& container) {
+        size_t count;
+
+        nextLine(key);
+        get(count);
+
+        container.clear();
+
+        for (size_t i = 0; i < count; i++) {
+            typename C::value_type val;
+
+            get(val);
+            container.push_back(val);
+        }
+    }
+
+protected:
+    void nextLine(const char * const key);
+    std::string nextToken();
+
+    void getAll() { };
+
+    template<typename T, typename... R>
+    void getAll(T& first, R&... rest) {
+        get(first);
+        getAll(rest...);
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type get(T& val) {
+        val = static_cast<T>(std::stoll(nextToken()));
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type get(T& val) {
+        val = static_cast<T>(std::stoull(nextToken()));
+    }
+
+    void get(double& val);
+    void get(SimTime& val);
+
+    std::istream& in;
+    std::istringstream line;
+    std::string lineKey;
+};
+
+#endif /* UTIL_SNAPSHOT_H_ */
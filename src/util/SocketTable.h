@@ -0,0 +1,180 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef UTIL_SOCKETTABLE_H_
+#define UTIL_SOCKETTABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <omnetpp.h>
+#include <inet/networklayer/common/L3Address.h>
+
+using namespace inet;
+
+
+/**
+ * Hash function for L3Address, allows for using it in unordered containers.
+ */
+struct L3AddressHash {
+    size_t operator()(const L3Address& addr) const {
+        size_t h = std::hash<int>()(addr.getType());
+
+        switch (addr.getType()) {
+        case L3Address::IPv4:
+            return combine(h, addr.toIPv4().getInt());
+        case L3Address::IPv6: {
+            const uint32_t * const words = addr.toIPv6().words();
+
+            for (int i = 0; i < 4; i++) {
+                h = combine(h, words[i]);
+            }
+
+            return h;
+        }
+        case L3Address::MAC:
+            return combine(h, addr.toMAC().getInt());
+        case L3Address::MODULEID:
+            return combine(h, addr.toModuleId().getId());
+        case L3Address::MODULEPATH:
+            return combine(h, addr.toModulePath().getId());
+        default:
+            return h;
+        }
+    }
+
+    static size_t combine(const size_t seed, const uint64_t value) {
+        return seed ^ (std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+};
+
+
+/**
+ * Socket handles of a transport, indexed by socket ID and by remote
+ * (L3Address, port) with O(1) lookups for both.
+ *
+ * Handle must provide the members L3Address remote and uint16_t port. The
+ * table does not take ownership of the handles. Changes of the remote port of
+ * a stored handle have to be applied through updatePort().
+ */
+template<typename Handle>
+class SocketTable {
+  public:
+    typedef typename std::vector<Handle *>::const_iterator const_iterator;
+
+    /**
+     * Stores handle with the given socket ID. Several handles might share a
+     * socket (e.g. incoming connections tied to the listen socket), the ID is
+     * then kept associated with the handle stored first.
+     */
+    void insert(const int id, Handle * const handle) {
+        ASSERT(handle);
+
+        byId.insert(typename IdMap_t::value_type(id, handle));
+
+        sequence[handle] = handles.size();
+        handles.push_back(handle);
+
+        AddrEntry& entry = byAddr[handle->remote];
+
+        entry.last = handle;
+        entry.byPort[handle->port].push_back(handle);
+    }
+
+    Handle * findById(const int id) const {
+        const auto it = byId.find(id);
+
+        return it == byId.end() ? nullptr : it->second;
+    }
+
+    /**
+     * Returns the handle connected to addr. If several handles share the
+     * address, the first one stored with a matching port is preferred,
+     * otherwise the one stored last is returned.
+     */
+    Handle * findByAddr(const L3Address& addr, const uint16_t port) const {
+        const auto it = byAddr.find(addr);
+
+        if (it == byAddr.end()) {
+            return nullptr;
+        }
+
+        const auto portIt = it->second.byPort.find(port);
+
+        if (portIt != it->second.byPort.end() && !portIt->second.empty()) {
+            return portIt->second.front();
+        }
+
+        return it->second.last;
+    }
+
+    void updatePort(Handle * const handle, const uint16_t port) {
+        ASSERT(sequence.count(handle));
+
+        if (handle->port == port) {
+            return;
+        }
+
+        auto& byPort = byAddr[handle->remote].byPort;
+        auto& oldBucket = byPort[handle->port];
+
+        oldBucket.erase(std::find(oldBucket.begin(), oldBucket.end(), handle));
+
+        if (oldBucket.empty()) {
+            byPort.erase(handle->port);
+        }
+
+        handle->port = port;
+
+        // keep the bucket in insertion order, first match wins
+        auto& newBucket = byPort[port];
+        const size_t seq = sequence[handle];
+        const auto pos = std::find_if(newBucket.begin(), newBucket.end(),
+                [this, seq](Handle * const h) { return sequence.at(h) > seq; });
+
+        newBucket.insert(pos, handle);
+    }
+
+    void clear() {
+        byId.clear();
+        byAddr.clear();
+        sequence.clear();
+        handles.clear();
+    }
+
+    size_t size() const { return handles.size(); };
+
+    // all handles in insertion order
+    const_iterator begin() const { return handles.begin(); };
+    const_iterator end() const { return handles.end(); };
+
+  protected:
+    typedef std::unordered_map<int, Handle *> IdMap_t;
+
+    struct AddrEntry {
+        Handle * last = nullptr;
+        std::unordered_map<uint16_t, std::vector<Handle *>> byPort;
+    };
+
+    IdMap_t byId;
+    std::unordered_map<L3Address, AddrEntry, L3AddressHash> byAddr;
+    std::unordered_map<const Handle *, size_t> sequence;
+    std::vector<Handle *> handles;
+};
+
+#endif /* UTIL_SOCKETTABLE_H_ */
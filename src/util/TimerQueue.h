@@ -0,0 +1,98 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef UTIL_TIMERQUEUE_H_
+#define UTIL_TIMERQUEUE_H_
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+
+/**
+ * Module-local queue of timer messages, which multiplexes many timers onto a
+ * single scheduled self-message of the owning module. Timers are kept ordered
+ * by their deadline and, for equal deadlines, by the order in which they were
+ * scheduled. Scheduling priorities are ignored. Only the order among the
+ * queued timers is preserved, their order relative to other events at the
+ * same simulation time differs from scheduling each timer on its own.
+ * Timers remain owned by the module, the queue never deletes them.
+ */
+class TimerQueue {
+  public:
+    void schedule(cMessage * const timer, const simtime_t& deadline) {
+        ASSERT(timer);
+
+        if (index.count(timer)) {
+            throw cRuntimeError("TimerQueue::schedule(): timer %s is already scheduled", timer->getName());
+        }
+
+        index[timer] = queue.emplace(Key(deadline, sequence++), timer).first;
+    }
+
+    // returns false if the timer was not scheduled
+    bool cancel(const cMessage * const timer) {
+        auto it = index.find(timer);
+
+        if (it == index.end()) {
+            return false;
+        }
+
+        queue.erase(it->second);
+        index.erase(it);
+
+        return true;
+    }
+
+    bool isScheduled(const cMessage * const timer) const { return index.count(timer) > 0; };
+    bool empty() const { return queue.empty(); };
+    size_t size() const { return queue.size(); };
+
+    // only valid if the queue is not empty
+    const simtime_t& nextDeadline() const { return queue.begin()->first.first; };
+
+    // removes and returns the earliest timer expired at now, nullptr if there is none
+    cMessage * popExpired(const simtime_t& now) {
+        if (queue.empty() || queue.begin()->first.first > now) {
+            return nullptr;
+        }
+
+        cMessage * const timer = queue.begin()->second;
+
+        queue.erase(queue.begin());
+        index.erase(timer);
+
+        return timer;
+    }
+
+    void clear() {
+        queue.clear();
+        index.clear();
+    }
+
+  private:
+    typedef std::pair<simtime_t, uint64_t> Key; // deadline, scheduling sequence number
+
+    std::map<Key, cMessage *> queue;
+    std::unordered_map<const cMessage *, std::map<Key, cMessage *>::iterator> index;
+    uint64_t sequence = 0;
+};
+
+#endif /* UTIL_TIMERQUEUE_H_ */
@@ -35,4 +35,17 @@ public:
     virtual inet::NetworkOptionsPtr replaceNetworkOptions(const inet::NetworkOptionsPtr networkOptions = nullptr);
 };
 
+/**
+ * Returns the TransportCtrlKind of a control info created from
+ * TransportCtrlMsg.msg, or 0 if there is none. The kind is only a tag,
+ * callers assert the actual type of the control info in debug builds.
+ */
+inline short getTransportCtrlKind(omnetpp::cObject * const ctrlInfo) {
+    if (ctrlInfo == nullptr || !ctrlInfo->isMessage()) {
+        return 0;
+    }
+
+    return static_cast<omnetpp::cMessage *>(ctrlInfo)->getKind();
+}
+
 #endif /* UTIL_TRANSPORTCTRLMSG_H_ */
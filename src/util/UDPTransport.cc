@@ -26,8 +26,8 @@ UDPTransport::UDPTransport() {
 }
 
 UDPTransport::~UDPTransport() {
-    // connectionVect contains each created handle, even the listening one
-    for (auto handle : connectionVect) {
+    // connectionTable contains each created handle, even the listening one
+    for (auto handle : connectionTable) {
         delete handle;
     }
 }
@@ -92,7 +92,7 @@ void UDPTransport::handleMessage(cMessage * const msg) {
                     txHandle->socket->sendTo(hs, txHandle->remote, txHandle->port);
                 } else {
                     // client side part, set port and flag connection as established
-                    handle->port = ctrl->getSrcPort();
+                    connectionTable.updatePort(handle, ctrl->getSrcPort());
                     handle->connected = true;
 
                     // confirm connection to upper layer
@@ -135,8 +135,11 @@ void UDPTransport::handleMessage(cMessage * const msg) {
     } else if (msg->arrivedOn(upIn->getId())) {
         cObject * const ctrlInfo = msg->getControlInfo();
 
-        if (dynamic_cast<TransportConnectReq *>(ctrlInfo)) {
-            TransportConnectReq * const req = dynamic_cast<TransportConnectReq *>(ctrlInfo);
+        switch (getTransportCtrlKind(ctrlInfo)) {
+        case TRANSPORT_CTRL_CONNECT_REQ: {
+            ASSERT(dynamic_cast<TransportConnectReq *>(ctrlInfo));
+
+            TransportConnectReq * const req = static_cast<TransportConnectReq *>(ctrlInfo);
 
             SocketHandle_t * const handle = createSocket();
 
@@ -151,8 +154,13 @@ void UDPTransport::handleMessage(cMessage * const msg) {
             initHandshake(handle, selfMsg);
 
             delete msg;
-        } else if (dynamic_cast<TransportListenReq *>(ctrlInfo)) {
-            const uint16_t listenPort = dynamic_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
+
+            break;
+        }
+        case TRANSPORT_CTRL_LISTEN_REQ: {
+            ASSERT(dynamic_cast<TransportListenReq *>(ctrlInfo));
+
+            const uint16_t listenPort = static_cast<TransportListenReq *>(ctrlInfo)->getListenPort();
 
             delete msg;
 
@@ -169,12 +177,14 @@ void UDPTransport::handleMessage(cMessage * const msg) {
             } else {
                 throw cRuntimeError("Already listening, refusing to listen twice");
             }
-        } else if (dynamic_cast<TransportDataInfo *>(ctrlInfo)) {
-            TransportDataInfo * const req = dynamic_cast<TransportDataInfo *>(msg->removeControlInfo());
 
-            if (req == nullptr) {
-                throw cRuntimeError("handleMessage(): expected TransportDataInfo control info in message.");
-            }
+            break;
+        }
+        case TRANSPORT_CTRL_DATA: {
+            ASSERT(dynamic_cast<TransportDataInfo *>(ctrlInfo));
+
+            TransportDataInfo * const req = static_cast<TransportDataInfo *>(msg->removeControlInfo());
+
             ASSERT(dynamic_cast<cPacket *>(msg));
 
             SocketHandle_t * const handle = getSocketByAddr(req->getDstAddr(), req->getDstPort());
@@ -187,7 +197,7 @@ void UDPTransport::handleMessage(cMessage * const msg) {
 
                     opts.networkOptions = req->replaceNetworkOptions();
 
-                    handle->socket->sendTo(dynamic_cast<cPacket *>(msg), handle->remote, handle->port, &opts);
+                    handle->socket->sendTo(static_cast<cPacket *>(msg), handle->remote, handle->port, &opts);
                 } else {
                     EV_WARN << "Connection to " << req->getDstAddr() << " is not established yet. Dropping message: " << msg << endl;
 
@@ -200,7 +210,10 @@ void UDPTransport::handleMessage(cMessage * const msg) {
             }
 
             delete req;
-        } else {
+
+            break;
+        }
+        default:
             EV_WARN << "Received message with unknown control info type, ignoring: " << msg << endl;
 
             delete msg;
@@ -249,12 +262,10 @@ void UDPTransport::connectSocket(SocketHandle_t * const handle, const L3Address
 void UDPTransport::storeSocket(SocketHandle_t * const handle) {
     ASSERT(handle);
 
-    // may fail for incoming connections tied to the listen socket
-    // thats ok, we use the map in first place to retrieve the listen socket or
-    // to check if a socket context has been established. thus no assert here
-    connectionMap.insert(SocketMap_t::value_type(handle->socket->getSocketId(), handle));
-
-    connectionVect.insert(connectionVect.end(), handle);
+    // the ID of incoming connections tied to the listen socket stays associated
+    // with the listen socket. thats ok, we use the ID in first place to retrieve
+    // the listen socket or to check if a socket context has been established
+    connectionTable.insert(handle->socket->getSocketId(), handle);
 }
 
 void UDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * const selfMsg) {
@@ -273,14 +284,9 @@ void UDPTransport::initHandshake(SocketHandle_t * const handle, cMessage * const
  * connections, or the socket associated with an outgoing connection.
  */
 UDPTransport::SocketHandle_t * UDPTransport::getSocketById(const int id) {
-    const auto it = connectionMap.find(id);
+    SocketHandle_t * const handle = connectionTable.findById(id);
 
-    if (it == connectionMap.end()) {
-        return nullptr;
-    }
-
-    SocketHandle_t * const handle = it->second;
-    ASSERT(it->first == handle->socket->getSocketId());
+    ASSERT(!handle || id == handle->socket->getSocketId());
 
     return handle;
 }
@@ -294,17 +300,5 @@ UDPTransport::SocketHandle_t * UDPTransport::getSocketById(const int id) {
  * requiring the server to know the dst port of the client.
  */
 UDPTransport::SocketHandle_t * UDPTransport::getSocketByAddr(const L3Address& addr, const uint16_t port) {
-    SocketHandle_t * handle = nullptr;
-
-    for (auto it = connectionVect.begin(); it != connectionVect.end(); it++) {
-        if ((*it)->remote == addr) {
-            handle = *it; // address match, but a perfect one might be possible
-
-            if (handle->port == port) {
-                break; // perfect match, do not continue
-            }
-        }
-    }
-
-    return handle;
+    return connectionTable.findByAddr(addr, port);
 }
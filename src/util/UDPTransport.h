@@ -23,6 +23,7 @@
 #include <inet/transportlayer/contract/udp/UDPSocket.h>
 
 #include "TransportCtrlMsg.h"
+#include "SocketTable.h"
 
 using namespace omnetpp;
 using namespace inet;
@@ -46,8 +47,7 @@ class UDPTransport : public cSimpleModule {
         uint16_t port;
         L3Address remote;
     };
-    typedef std::map<int, SocketHandle_t *> SocketMap_t;
-    typedef std::vector<SocketHandle_t *> SocketVector_t;
+    typedef SocketTable<SocketHandle_t> SocketTable_t;
 
     // variables
     cGate *udpIn;
@@ -55,8 +55,7 @@ class UDPTransport : public cSimpleModule {
     cGate *upIn;
     cGate *upOut;
 
-    SocketMap_t connectionMap; // ConnId --> SocketHandle_t;
-    SocketVector_t connectionVect;
+    SocketTable_t connectionTable; // ConnId, remote address --> SocketHandle_t
     SocketHandle_t * listenSocket = nullptr;
 
     // socket management methods
@@ -0,0 +1,113 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(const unsigned int numThreads) {
+    threads.reserve(numThreads);
+
+    for (unsigned int i = 0; i < numThreads; i++) {
+        threads.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        shutdown = true;
+    }
+
+    tasksAvailable.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+unsigned int WorkerPool::size() const {
+    return threads.size();
+}
+
+void WorkerPool::run(std::vector<Task_t>& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    pending = &tasks;
+    nextTask = 0;
+    finishedTasks = 0;
+    failure = nullptr;
+
+    tasksAvailable.notify_all();
+
+    // take part in processing, then wait for the tasks still running on workers
+    processTasks(lock);
+    tasksDone.wait(lock, [&]{ return finishedTasks == tasks.size(); });
+
+    pending = nullptr;
+
+    if (failure) {
+        std::exception_ptr error = failure;
+
+        failure = nullptr;
+        lock.unlock();
+
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        tasksAvailable.wait(lock, [this]{ return shutdown || (pending && nextTask < pending->size()); });
+
+        if (shutdown) {
+            return;
+        }
+
+        processTasks(lock);
+    }
+}
+
+void WorkerPool::processTasks(std::unique_lock<std::mutex>& lock) {
+    while (pending && nextTask < pending->size()) {
+        Task_t& task = (*pending)[nextTask++];
+        const size_t taskCount = pending->size();
+        std::exception_ptr error;
+
+        lock.unlock();
+
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+
+        if (error && !failure) {
+            failure = error;
+        }
+
+        if (++finishedTasks == taskCount) {
+            tasksDone.notify_all();
+        }
+    }
+}
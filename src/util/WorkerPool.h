@@ -0,0 +1,63 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef UTIL_WORKERPOOL_H_
+#define UTIL_WORKERPOOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Minimal fixed-size thread pool for running a batch of independent tasks.
+ * The calling thread takes part in processing the batch, thus a pool with
+ * zero threads simply runs all tasks sequentially.
+ */
+class WorkerPool {
+
+public:
+    typedef std::function<void()> Task_t;
+
+    WorkerPool(const unsigned int numThreads);
+    virtual ~WorkerPool();
+
+    unsigned int size() const;
+
+    // runs all tasks in arbitrary order and blocks until every task has finished
+    // the first exception thrown by a task is rethrown afterwards
+    void run(std::vector<Task_t>& tasks);
+
+protected:
+    void work();
+    void processTasks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable tasksAvailable;
+    std::condition_variable tasksDone;
+
+    std::vector<Task_t> * pending = nullptr;
+    size_t nextTask = 0;
+    size_t finishedTasks = 0;
+    std::exception_ptr failure;
+    bool shutdown = false;
+};
+
+#endif /* UTIL_WORKERPOOL_H_ */